@@ -0,0 +1,342 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <atomic>
+#include <chrono>
+#include <stdint.h>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief The LatencyHistogram class
+ *
+ * Log-linear histogram of nanosecond latencies. Every power of two is split
+ * into 8 sub-buckets, so the reported percentiles are within 12.5% of the
+ * measured value.
+ */
+class LatencyHistogram
+{
+public:
+    LatencyHistogram() : m_count(0), m_max(0)
+    {
+        for (uint16_t i = 0; i < BUCKETS; i++)
+        {
+            m_buckets[i] = 0;
+        }
+    }
+
+    /**
+     * @brief record
+     * @param ns latency in nanoseconds
+     */
+    void record(uint64_t ns)
+    {
+        m_buckets[index(ns)]++;
+        m_count++;
+        if (ns > m_max)
+            m_max = ns;
+    }
+
+    /**
+     * @brief merge
+     * @param other histogram which is added to this one
+     */
+    void merge(const LatencyHistogram &other)
+    {
+        for (uint16_t i = 0; i < BUCKETS; i++)
+        {
+            m_buckets[i] += other.m_buckets[i];
+        }
+        m_count += other.m_count;
+        if (other.m_max > m_max)
+            m_max = other.m_max;
+    }
+
+    /**
+     * @brief percentile
+     * @param p percentile in the range [0, 1]
+     * @return lower bound of the bucket containing the percentile
+     */
+    uint64_t percentile(double p) const
+    {
+        uint64_t rank = (uint64_t)(p * (double)m_count);
+        uint64_t seen = 0;
+        for (uint16_t i = 0; i < BUCKETS; i++)
+        {
+            seen += m_buckets[i];
+            if (seen > rank)
+                return value(i);
+        }
+        return m_max;
+    }
+
+    uint64_t count(void) const { return m_count; }
+    uint64_t max(void) const { return m_max; }
+
+private:
+    static const uint8_t SUB_BITS = 3;
+    static const uint16_t BUCKETS = 64 << SUB_BITS;
+
+    static uint16_t index(uint64_t v)
+    {
+        if (v < (1u << SUB_BITS))
+            return (uint16_t)v;
+        uint8_t msb = 63 - __builtin_clzll(v);
+        uint8_t shift = msb - SUB_BITS;
+        return (uint16_t)(((shift + 1) << SUB_BITS) + ((v >> shift) & ((1u << SUB_BITS) - 1)));
+    }
+
+    static uint64_t value(uint16_t idx)
+    {
+        if (idx < (1u << SUB_BITS))
+            return idx;
+        uint8_t shift = (idx >> SUB_BITS) - 1;
+        return (uint64_t)((1u << SUB_BITS) | (idx & ((1u << SUB_BITS) - 1))) << shift;
+    }
+
+    uint64_t m_buckets[BUCKETS];
+    uint64_t m_count;
+    uint64_t m_max;
+};
+
+/**
+ * @brief Parameters of one benchmark case.
+ */
+struct BenchCase
+{
+    const char *container;
+    const char *operation;
+    uint32_t elementSize;
+    uint32_t capacity;
+    uint32_t threads;
+};
+
+/**
+ * @brief Result of one benchmark case.
+ */
+struct BenchResult
+{
+    BenchCase params;
+    uint64_t operations;
+    double seconds;
+    uint64_t allocations;
+    uint64_t p50;
+    uint64_t p99;
+    uint64_t p999;
+    uint64_t max;
+};
+
+typedef void (*BenchSuiteFunction)(void);
+
+/**
+ * @brief Registers a suite function at static initialisation time.
+ */
+struct BenchSuite
+{
+    BenchSuite(const char *name, BenchSuiteFunction function);
+};
+
+/**
+ * @brief Define and register a benchmark suite.
+ */
+#define BENCH_SUITE(name)                                                 \
+    static void bench_suite_##name(void);                                 \
+    static BenchSuite bench_suite_registrar_##name(#name, bench_suite_##name); \
+    static void bench_suite_##name(void)
+
+/**
+ * @brief Number of operations each case should run.
+ */
+uint64_t benchOperations(void);
+
+/**
+ * @brief Number of heap allocations done by the process so far.
+ */
+uint64_t benchAllocations(void);
+
+/**
+ * @brief Store a result for the report.
+ */
+void benchReport(const BenchResult &result);
+
+/**
+ * @brief Keep a computed value alive so the measured code is not dropped.
+ */
+void benchSink(uint64_t value);
+
+/**
+ * @brief Stop the run with an error if a case computed a wrong result.
+ *
+ * @param ok result of the comparison against a reference
+ * @param what description printed on failure
+ */
+void benchCheck(bool ok, const char *what);
+
+/**
+ * @brief Thread counts used by multi-threaded cases.
+ */
+static const uint32_t BENCH_THREADS[] = {1, 2, 4, 8};
+static const uint8_t BENCH_THREAD_VARIANTS = sizeof(BENCH_THREADS) / sizeof(BENCH_THREADS[0]);
+
+/**
+ * @brief Element type of a given size.
+ */
+template <uint32_t Size>
+struct BenchElement
+{
+    uint8_t bytes[Size];
+};
+
+inline uint64_t benchNow(void)
+{
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+/**
+ * @brief Run a single threaded case.
+ *
+ * The operations are split into batches of batch operations. setup() is
+ * called untimed before every batch, so operations which fill or drain a
+ * container can restore their start state. The first pass measures the
+ * throughput, the second pass records the latency of every operation.
+ *
+ * @param params case description
+ * @param batch operations per batch
+ * @param setup callable run before every batch
+ * @param op callable taking the operation index
+ */
+template <class Setup, class Op>
+void benchRun(const BenchCase &params, uint64_t batch, Setup setup, Op op)
+{
+    uint64_t operations = benchOperations();
+    BenchResult result;
+    LatencyHistogram histogram;
+    uint64_t elapsed = 0;
+
+    if (batch == 0 || batch > operations)
+        batch = operations;
+    operations -= operations % batch;
+
+    uint64_t allocations = benchAllocations();
+    for (uint64_t done = 0; done < operations; done += batch)
+    {
+        setup();
+        uint64_t start = benchNow();
+        for (uint64_t i = 0; i < batch; i++)
+        {
+            op(done + i);
+        }
+        elapsed += benchNow() - start;
+    }
+    result.allocations = benchAllocations() - allocations;
+
+    for (uint64_t done = 0; done < operations; done += batch)
+    {
+        setup();
+        for (uint64_t i = 0; i < batch; i++)
+        {
+            uint64_t start = benchNow();
+            op(done + i);
+            histogram.record(benchNow() - start);
+        }
+    }
+
+    result.params = params;
+    result.operations = operations;
+    result.seconds = (double)elapsed / 1e9;
+    result.p50 = histogram.percentile(0.50);
+    result.p99 = histogram.percentile(0.99);
+    result.p999 = histogram.percentile(0.999);
+    result.max = histogram.max();
+    benchReport(result);
+}
+
+/**
+ * @brief Run a single threaded case without setup.
+ */
+template <class Op>
+void benchRun(const BenchCase &params, Op op)
+{
+    benchRun(params, 0, []() {}, op);
+}
+
+/**
+ * @brief Run a case on params.threads threads at the same time.
+ *
+ * Every thread runs benchOperations() / threads operations, op is called
+ * with the thread number and the operation index. The throughput is the
+ * total number of operations divided by the wall time of the first pass.
+ */
+template <class Op>
+void benchRunThreads(const BenchCase &params, Op op)
+{
+    uint32_t threads = params.threads;
+    uint64_t perThread = benchOperations() / threads;
+    std::vector<LatencyHistogram> histograms(threads);
+    BenchResult result;
+    uint64_t elapsed = 0;
+    uint64_t allocations = 0;
+
+    for (uint8_t pass = 0; pass < 2; pass++)
+    {
+        std::atomic<uint32_t> ready(0);
+        std::atomic<bool> go(false);
+        std::vector<std::thread> workers;
+
+        for (uint32_t t = 0; t < threads; t++)
+        {
+            workers.emplace_back([&, t, pass]() {
+                ready++;
+                while (!go.load(std::memory_order_acquire))
+                    std::this_thread::yield();
+
+                for (uint64_t i = 0; i < perThread; i++)
+                {
+                    if (pass == 0)
+                    {
+                        op(t, i);
+                    }
+                    else
+                    {
+                        uint64_t start = benchNow();
+                        op(t, i);
+                        histograms[t].record(benchNow() - start);
+                    }
+                }
+            });
+        }
+        while (ready.load() != threads)
+            std::this_thread::yield();
+
+        allocations = benchAllocations();
+        uint64_t start = benchNow();
+        go.store(true, std::memory_order_release);
+        for (uint32_t t = 0; t < threads; t++)
+        {
+            workers[t].join();
+        }
+        if (pass == 0)
+        {
+            elapsed = benchNow() - start;
+            result.allocations = benchAllocations() - allocations;
+        }
+    }
+
+    for (uint32_t t = 1; t < threads; t++)
+    {
+        histograms[0].merge(histograms[t]);
+    }
+
+    result.params = params;
+    result.operations = perThread * threads;
+    result.seconds = (double)elapsed / 1e9;
+    result.p50 = histograms[0].percentile(0.50);
+    result.p99 = histograms[0].percentile(0.99);
+    result.p999 = histograms[0].percentile(0.999);
+    result.max = histograms[0].max();
+    benchReport(result);
+}
+
+#endif
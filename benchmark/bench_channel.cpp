@@ -0,0 +1,101 @@
+/*
+ * FiFoChannel benchmarks, only built with C++20 coroutine support.
+ */
+#include "Bench.h"
+#include "FiFoChannel.h"
+
+#if defined(__cpp_impl_coroutine) && __cpp_impl_coroutine >= 201902L
+
+#include <exception>
+#include <vector>
+
+/**
+ * @brief Coroutine type which starts immediately and frees itself at the end.
+ */
+struct DetachedTask
+{
+    struct promise_type
+    {
+        DetachedTask get_return_object(void) { return DetachedTask(); }
+        std::suspend_never initial_suspend(void) { return std::suspend_never(); }
+        std::suspend_never final_suspend(void) noexcept { return std::suspend_never(); }
+        void return_void(void) {}
+        void unhandled_exception(void) { std::terminate(); }
+    };
+};
+
+typedef FiFoChannel<uint32_t> Channel;
+
+static DetachedTask consume(Channel &channel, uint32_t &sink)
+{
+    while (std::optional<uint32_t> value = co_await channel.read())
+    {
+        sink += *value;
+    }
+}
+
+static DetachedTask produce(Channel &channel, uint32_t value)
+{
+    co_await channel.write(value);
+}
+
+static DetachedTask produceMany(Channel &channel, uint32_t count)
+{
+    for (uint32_t i = 0; i < count; i++)
+    {
+        co_await channel.write(i);
+    }
+}
+
+static DetachedTask consumeMany(Channel &channel, uint32_t count, uint32_t &sink)
+{
+    for (uint32_t i = 0; i < count; i++)
+    {
+        sink += *co_await channel.read();
+    }
+}
+
+BENCH_SUITE(channel)
+{
+    const uint16_t capacity = 64;
+    std::vector<uint8_t> storage(capacity * sizeof(uint32_t));
+    uint32_t sink = 0;
+
+    // Consumer waits on an empty channel, every write is a direct handoff
+    {
+        FiFo<uint32_t> fifo;
+        FiFoChannelExecutor executor;
+        fifo.initBuffer(&storage[0], (uint16_t)storage.size());
+        Channel channel(fifo, executor);
+        consume(channel, sink);
+
+        BenchCase handoff = {"FiFoChannel", "handoff_spawn", sizeof(uint32_t), capacity, 1};
+        benchRun(handoff, [&](uint64_t i) {
+            produce(channel, (uint32_t)i);
+            executor.run();
+        });
+        channel.close();
+        executor.run();
+    }
+
+    // One operation moves 64 elements; with 4 slots producer and consumer
+    // alternate between suspending and waking each other
+    const uint16_t depths[] = {64, 4};
+    for (uint8_t d = 0; d < 2; d++)
+    {
+        FiFo<uint32_t> fifo;
+        FiFoChannelExecutor executor;
+        fifo.initBuffer(&storage[0], (uint16_t)(depths[d] * sizeof(uint32_t)));
+        Channel channel(fifo, executor);
+
+        BenchCase burst = {"FiFoChannel", "burst_64", sizeof(uint32_t), depths[d], 1};
+        benchRun(burst, [&](uint64_t) {
+            produceMany(channel, 64);
+            consumeMany(channel, 64, sink);
+            executor.run();
+        });
+    }
+    benchSink(sink);
+}
+
+#endif
@@ -0,0 +1,90 @@
+/*
+ * CompressedRingBuffer benchmarks against RingBuffer<int32_t> with the same
+ * memory budget. The capacity column reports how many samples each
+ * container holds in that budget, so the ratio of the two is the
+ * compression ratio. "slow" samples are a random walk with steps of up to
+ * 3 counts, "noisy" samples step by up to 100 counts.
+ */
+#include <vector>
+#include "Bench.h"
+#include "CompressedRingBuffer.h"
+#include "RingBuffer.h"
+
+static const uint32_t COMPRESSED_MEMORY = 65536;
+static const uint16_t COMPRESSED_BLOCK_BYTES = 64;
+static const uint16_t COMPRESSED_RUN = 64;
+
+static int32_t compressedSample(int32_t previous, uint32_t &seed, int32_t step)
+{
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+    return previous + (int32_t)(seed % (uint32_t)(2 * step + 1)) - step;
+}
+
+struct CompressedSignal
+{
+    int32_t step;
+    const char *add;
+    const char *at;
+    const char *read;
+};
+
+static void benchCompressed(const CompressedSignal &signal)
+{
+    typedef CompressedRingBuffer<COMPRESSED_BLOCK_BYTES> Compressed;
+    uint16_t blocks = (uint16_t)(COMPRESSED_MEMORY / (COMPRESSED_BLOCK_BYTES + 12));
+    uint16_t plainSize = (uint16_t)(COMPRESSED_MEMORY / sizeof(int32_t));
+    Compressed compressed(blocks);
+    RingBuffer<int32_t> plain(plainSize);
+    std::vector<int32_t> out(COMPRESSED_RUN);
+    uint32_t seed = 2463534242u;
+    int32_t value = 0;
+    uint32_t sink = 0;
+
+    // Fill both far beyond their capacity so the compressed buffer evicts blocks
+    for (uint32_t i = 0; i < 4 * COMPRESSED_MEMORY; i++)
+    {
+        value = compressedSample(value, seed, signal.step);
+        compressed.add(value);
+        plain.add(value);
+    }
+
+    uint32_t held = compressed.length();
+    BenchCase add = {"Compressed", signal.add, sizeof(int32_t), held, 1};
+    benchRun(add, [&](uint64_t) {
+        value = compressedSample(value, seed, signal.step);
+        compressed.add(value);
+    });
+
+    held = compressed.length();
+    BenchCase at = {"Compressed", signal.at, sizeof(int32_t), held, 1};
+    benchRun(at, [&](uint64_t i) { sink += compressed.at(-1 - (int32_t)((i * 7919u) % held)); });
+
+    BenchCase plainAt = {"RingBuffer", signal.at, sizeof(int32_t), plainSize, 1};
+    benchRun(plainAt, [&](uint64_t i) { sink += plain.at(-1 - (int16_t)((i * 7919u) % plainSize)); });
+
+    // One operation reads COMPRESSED_RUN consecutive samples
+    BenchCase decode = {"Compressed", signal.read, sizeof(int32_t), held, 1};
+    benchRun(decode, [&](uint64_t i) {
+        compressed.decode((uint32_t)((i * 7919u) % (held - COMPRESSED_RUN)), &out[0], COMPRESSED_RUN);
+        sink += out[COMPRESSED_RUN - 1];
+    });
+
+    BenchCase plainRun = {"RingBuffer", signal.read, sizeof(int32_t), plainSize, 1};
+    benchRun(plainRun, [&](uint64_t i) {
+        int16_t start = -1 - (int16_t)((i * 7919u) % (plainSize - COMPRESSED_RUN));
+        for (uint16_t k = 0; k < COMPRESSED_RUN; k++)
+            out[k] = plain.at((int16_t)(start - k));
+        sink += out[COMPRESSED_RUN - 1];
+    });
+    benchSink(sink);
+}
+
+BENCH_SUITE(compressed_ring_buffer)
+{
+    const CompressedSignal slow = {3, "add_slow", "at_slow", "read_64_slow"};
+    const CompressedSignal noisy = {100, "add_noisy", "at_noisy", "read_64_noisy"};
+    benchCompressed(slow);
+    benchCompressed(noisy);
+}
@@ -0,0 +1,55 @@
+/*
+ * FiFoFanIn benchmarks: dispatch cost with few active channels out of
+ * many, against polling dataAvailable() on every channel.
+ */
+#include <vector>
+#include "Bench.h"
+#include "FiFoFanIn.h"
+
+static const uint16_t FAN_IN_CHANNELS = 512;
+static const uint16_t FAN_IN_ACTIVE[] = {1, 8, 64, 512};
+static const uint16_t FAN_IN_DEPTH = 64;
+
+BENCH_SUITE(fan_in)
+{
+    std::vector<uint8_t> storage(FAN_IN_CHANNELS * FAN_IN_DEPTH * sizeof(uint32_t));
+    std::vector<FiFo<uint32_t> > fifos(FAN_IN_CHANNELS);
+    FiFoFanIn<uint32_t, FAN_IN_CHANNELS> *fan = new FiFoFanIn<uint32_t, FAN_IN_CHANNELS>(4);
+    uint32_t sink = 0;
+
+    for (uint16_t i = 0; i < FAN_IN_CHANNELS; i++)
+    {
+        fifos[i].initBuffer(&storage[i * FAN_IN_DEPTH * sizeof(uint32_t)], FAN_IN_DEPTH * sizeof(uint32_t));
+        fan->attach(i, &fifos[i]);
+    }
+
+    for (uint8_t a = 0; a < sizeof(FAN_IN_ACTIVE) / sizeof(FAN_IN_ACTIVE[0]); a++)
+    {
+        uint16_t active = FAN_IN_ACTIVE[a];
+        uint16_t stride = FAN_IN_CHANNELS / active;
+
+        // The capacity column reports the number of active channels. One
+        // operation: every active channel receives one element, then one tick.
+        BenchCase dispatch = {"FiFoFanIn", "write_dispatch", sizeof(uint32_t), active, 1};
+        benchRun(dispatch, [&](uint64_t i) {
+            uint32_t value = (uint32_t)i;
+            for (uint16_t c = 0; c < active; c++)
+                fan->write(c * stride, value);
+            fan->dispatch([&](uint16_t, uint32_t &v) { sink += v; });
+        });
+
+        BenchCase poll = {"FiFoFanIn", "write_poll_all", sizeof(uint32_t), active, 1};
+        benchRun(poll, [&](uint64_t i) {
+            uint32_t value = (uint32_t)i;
+            for (uint16_t c = 0; c < active; c++)
+                fifos[c * stride].write(&value);
+            for (uint16_t c = 0; c < FAN_IN_CHANNELS; c++)
+            {
+                for (uint8_t n = 0; n < 4 && fifos[c].dataAvailable(); n++)
+                    sink += fifos[c].read();
+            }
+        });
+    }
+    delete fan;
+    benchSink(sink);
+}
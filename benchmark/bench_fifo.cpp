@@ -0,0 +1,166 @@
+/*
+ * FiFo benchmarks.
+ */
+#include <mutex>
+#include <string.h>
+#include <vector>
+#include "Bench.h"
+#include "FiFo.h"
+
+static const uint32_t FIFO_CAPACITIES[] = {16, 256, 4096, 65535};
+
+template <uint32_t Size>
+static void benchFiFo(uint32_t capacity)
+{
+    typedef BenchElement<Size> Element;
+    uint32_t bytes = capacity * Size;
+
+    // FiFo indices are 16 bit wide
+    if (bytes > 0xFFFFu)
+        return;
+
+    std::vector<uint8_t> storage(bytes);
+    FiFo<Element> fifo;
+    Element element = Element();
+    uint32_t sink = 0;
+
+    BenchCase write = {"FiFo", "write", Size, capacity, 1};
+    benchRun(write, capacity, [&]() { fifo.initBuffer(&storage[0], bytes); },
+             [&](uint64_t) { fifo.write(&element); });
+
+    BenchCase read = {"FiFo", "read", Size, capacity, 1};
+    benchRun(read, capacity,
+             [&]() {
+                 fifo.initBuffer(&storage[0], bytes);
+                 for (uint32_t i = 0; i < capacity; i++)
+                     fifo.write(&element);
+             },
+             [&](uint64_t) { sink += fifo.read().bytes[0]; });
+
+    BenchCase writeRead = {"FiFo", "write_read", Size, capacity, 1};
+    fifo.initBuffer(&storage[0], bytes);
+    benchRun(writeRead, [&](uint64_t) {
+        fifo.write(&element);
+        sink += fifo.read().bytes[0];
+    });
+
+    // Batched operations, one operation moves the whole capacity
+    std::vector<Element> block(capacity);
+    auto refill = [&]() {
+        fifo.initBuffer(&storage[0], bytes);
+        for (uint32_t i = 0; i < capacity; i++)
+            fifo.write(&element);
+    };
+
+    BenchCase readLoop = {"FiFo", "read_all_loop", Size, capacity, 1};
+    benchRun(readLoop, 1, refill, [&](uint64_t) {
+        for (uint32_t i = 0; i < capacity; i++)
+            block[i] = fifo.read();
+    });
+
+    BenchCase drainInto = {"FiFo", "drain_into_all", Size, capacity, 1};
+    benchRun(drainInto, 1, refill, [&](uint64_t) { fifo.drain_into(&block[0], (uint16_t)capacity); });
+
+    BenchCase drain = {"FiFo", "drain_all", Size, capacity, 1};
+    benchRun(drain, 1, refill, [&](uint64_t) {
+        fifo.drain((uint16_t)capacity, [&](const Element *e, uint16_t n) {
+            for (uint16_t i = 0; i < n; i++)
+                sink += e[i].bytes[0];
+        });
+    });
+
+    BenchCase writeLoop = {"FiFo", "write_all_loop", Size, capacity, 1};
+    benchRun(writeLoop, 1, [&]() { fifo.initBuffer(&storage[0], bytes); }, [&](uint64_t) {
+        for (uint32_t i = 0; i < capacity; i++)
+            fifo.write(&block[i]);
+    });
+
+    BenchCase fill = {"FiFo", "fill_all", Size, capacity, 1};
+    benchRun(fill, 1, [&]() { fifo.initBuffer(&storage[0], bytes); }, [&](uint64_t) {
+        fifo.fill((uint16_t)capacity, [&](Element *slots, uint16_t n) {
+            memcpy(slots, &block[0], n * sizeof(Element));
+            return n;
+        });
+    });
+    fifo.initBuffer(&storage[0], bytes);
+
+    BenchCase writeReadStats = {"FiFo", "write_read_stats", Size, capacity, 1};
+    FiFo<Element, BufferStats> counted;
+    counted.initBuffer(&storage[0], bytes);
+    benchRun(writeReadStats, [&](uint64_t) {
+        counted.write(&element);
+        sink += counted.read().bytes[0];
+    });
+
+    BenchCase writeReadTrace = {"FiFo", "write_read_trace", Size, capacity, 1};
+    FiFo<Element, BufferNoStats, FiFoLatencyTrace> traced;
+    std::vector<BufferTimestamp_t> stamps(capacity);
+    traced.initBuffer(&storage[0], bytes);
+    traced.initTrace(&stamps[0], (uint16_t)capacity);
+    benchRun(writeReadTrace, [&](uint64_t) {
+        traced.write(&element);
+        sink += traced.read().bytes[0];
+    });
+
+    // Marks armed but never crossed, measures the compare in the write and read paths
+    BenchCase writeReadWatermarks = {"FiFo", "write_read_watermarks", Size, capacity, 1};
+    FiFo<Element, BufferNoStats, FiFoNoTrace, FiFoWatermarks> marked;
+    uint32_t crossings = 0;
+    marked.initBuffer(&storage[0], bytes);
+    marked.setWatermarks((uint16_t)(bytes - bytes / 4), (uint16_t)(bytes / 4),
+                         [](FIFO_Watermark_e, uint16_t, void *context) { (*(uint32_t *)context)++; },
+                         &crossings);
+    benchRun(writeReadWatermarks, [&](uint64_t) {
+        marked.write(&element);
+        sink += marked.read().bytes[0];
+    });
+    sink += crossings;
+
+    BenchCase freeSpace = {"FiFo", "getFreeBufferSpace", Size, capacity, 1};
+    benchRun(freeSpace, [&](uint64_t) { sink += fifo.getFreeBufferSpace(); });
+
+    BenchCase used = {"FiFo", "getUsedBufferSize", Size, capacity, 1};
+    benchRun(used, [&](uint64_t) { sink += fifo.getUsedBufferSize(); });
+
+    BenchCase available = {"FiFo", "dataAvailable", Size, capacity, 1};
+    benchRun(available, [&](uint64_t) { sink += fifo.dataAvailable(); });
+
+    BenchCase status = {"FiFo", "getBufferStatus", Size, capacity, 1};
+    benchRun(status, [&](uint64_t) { sink += fifo.getBufferStatus(); });
+    benchSink(sink);
+}
+
+template <uint32_t Size>
+static void benchFiFoCapacities(void)
+{
+    for (uint8_t c = 0; c < sizeof(FIFO_CAPACITIES) / sizeof(FIFO_CAPACITIES[0]); c++)
+    {
+        benchFiFo<Size>(FIFO_CAPACITIES[c]);
+    }
+}
+
+BENCH_SUITE(fifo)
+{
+    benchFiFoCapacities<1>();
+    benchFiFoCapacities<8>();
+    benchFiFoCapacities<64>();
+    benchFiFoCapacities<256>();
+
+    // Shared FiFo behind a mutex, every thread writes and reads one element
+    const uint32_t capacity = 4096;
+    std::vector<uint8_t> storage(capacity * sizeof(uint64_t));
+    FiFo<uint64_t> fifo;
+    std::mutex lock;
+
+    for (uint8_t t = 0; t < BENCH_THREAD_VARIANTS; t++)
+    {
+        BenchCase shared = {"FiFo", "locked_write_read", sizeof(uint64_t), capacity, BENCH_THREADS[t]};
+        fifo.initBuffer(&storage[0], (uint16_t)storage.size());
+        benchRunThreads(shared, [&](uint32_t, uint64_t i) {
+            uint64_t value = i;
+            std::lock_guard<std::mutex> guard(lock);
+            fifo.write(&value);
+            value = fifo.read();
+        });
+    }
+}
@@ -0,0 +1,85 @@
+/*
+ * FiFo file descriptor benchmarks: moving queued bytes through a pipe with
+ * write_to_fd() / read_from_fd() against copying them through a scratch
+ * buffer with drain_into() / fill() and write() / read(). One operation
+ * sends one chunk from a transmit FiFo to a receive FiFo.
+ */
+#if defined(__linux__)
+
+#include <string.h>
+#include <unistd.h>
+#include <vector>
+#include "Bench.h"
+#include "FiFo.h"
+
+static const uint16_t FIFO_FD_SIZE = 32768;
+static const uint16_t FIFO_FD_CHUNKS[] = {64, 1024, 16384};
+
+BENCH_SUITE(fifo_fd)
+{
+    std::vector<uint8_t> txStorage(FIFO_FD_SIZE);
+    std::vector<uint8_t> rxStorage(FIFO_FD_SIZE);
+    std::vector<uint8_t> scratch(FIFO_FD_SIZE);
+    FiFo<uint8_t> tx;
+    FiFo<uint8_t> rx;
+    uint32_t sink = 0;
+    int pipeFd[2];
+
+    if (pipe(pipeFd) != 0)
+        return;
+
+    auto produce = [&](uint8_t *slots, uint16_t count) -> uint16_t {
+        memset(slots, 0x5A, count);
+        return count;
+    };
+    auto consume = [&](const uint8_t *data, uint16_t count) { sink += data[0] + count; };
+
+    for (uint8_t c = 0; c < sizeof(FIFO_FD_CHUNKS) / sizeof(FIFO_FD_CHUNKS[0]); c++)
+    {
+        uint16_t chunk = FIFO_FD_CHUNKS[c];
+
+        tx.initBuffer(&txStorage[0], FIFO_FD_SIZE);
+        rx.initBuffer(&rxStorage[0], FIFO_FD_SIZE);
+        BenchCase vectored = {"FiFo", "fd_writev_readv", chunk, FIFO_FD_SIZE, 1};
+        benchRun(vectored, [&](uint64_t) {
+            tx.fill(chunk, produce);
+            ssize_t sent = tx.write_to_fd(pipeFd[1], chunk);
+            while (sent > 0)
+            {
+                ssize_t got = rx.read_from_fd(pipeFd[0], (uint16_t)sent);
+                if (got <= 0)
+                    break;
+                sent -= got;
+            }
+            rx.drain(chunk, consume);
+        });
+
+        tx.initBuffer(&txStorage[0], FIFO_FD_SIZE);
+        rx.initBuffer(&rxStorage[0], FIFO_FD_SIZE);
+        BenchCase copied = {"FiFo", "fd_copy_write_read", chunk, FIFO_FD_SIZE, 1};
+        benchRun(copied, [&](uint64_t) {
+            tx.fill(chunk, produce);
+            uint16_t n = tx.drain_into(&scratch[0], chunk);
+            ssize_t sent = write(pipeFd[1], &scratch[0], n);
+            while (sent > 0)
+            {
+                ssize_t got = read(pipeFd[0], &scratch[0], (size_t)sent);
+                if (got <= 0)
+                    break;
+                const uint8_t *src = &scratch[0];
+                rx.fill((uint16_t)got, [&](uint8_t *slots, uint16_t count) -> uint16_t {
+                    memcpy(slots, src, count);
+                    src += count;
+                    return count;
+                });
+                sent -= got;
+            }
+            rx.drain(chunk, consume);
+        });
+    }
+    close(pipeFd[0]);
+    close(pipeFd[1]);
+    benchSink(sink);
+}
+
+#endif
@@ -0,0 +1,63 @@
+/*
+ * FrameExchange benchmarks against passing frames through a byte FiFo. One
+ * operation hands one frame from the producer to the consumer in the same
+ * thread. The producer only stamps the frame header, as a DMA driver would
+ * have filled the rest; the consumer checks the header. The FiFo copies the
+ * frame in with write() and out with drain_into().
+ */
+#include <vector>
+#include "Bench.h"
+#include "FiFo.h"
+#include "FrameExchange.h"
+
+static const uint32_t FRAME_SIZES[] = {256, 4096, 16384};
+static const uint8_t FRAME_COUNT = 3;
+
+static void benchFrames(uint32_t frameSize)
+{
+    std::vector<uint8_t> storage(FRAME_COUNT * frameSize);
+    std::vector<uint8_t> scratch(frameSize);
+    uint8_t *frames[FRAME_COUNT];
+    FrameExchange exchange;
+    FiFo<uint8_t> fifo;
+    uint64_t sink = 0;
+
+    for (uint8_t f = 0; f < FRAME_COUNT; f++)
+        frames[f] = &storage[f * frameSize];
+
+    auto handOver = [&](uint64_t i) {
+        uint8_t *frame = exchange.acquire_write();
+        frame[0] = (uint8_t)i;
+        exchange.publish();
+        uint32_t length = 0;
+        const uint8_t *got = exchange.acquire_read(&length);
+        sink += got[0] + length;
+        exchange.release();
+    };
+
+    exchange.initBuffers(frames, 2, frameSize, FRAME_EXCHANGE_QUEUE);
+    BenchCase pingPong = {"FrameExchange", "frame_ping_pong", frameSize, 2, 1};
+    benchRun(pingPong, handOver);
+
+    exchange.initBuffers(frames, FRAME_COUNT, frameSize, FRAME_EXCHANGE_LATEST);
+    BenchCase latest = {"FrameExchange", "frame_latest", frameSize, FRAME_COUNT, 1};
+    benchRun(latest, handOver);
+
+    fifo.initBuffer(&storage[0], (uint16_t)(2 * frameSize));
+    BenchCase copied = {"FiFo", "frame_copy", frameSize, 2, 1};
+    benchRun(copied, [&](uint64_t i) {
+        scratch[0] = (uint8_t)i;
+        fifo.write(&scratch[0], (uint16_t)frameSize);
+        uint16_t length = fifo.drain_into(&scratch[0], (uint16_t)frameSize);
+        sink += scratch[0] + length;
+    });
+    benchSink(sink);
+}
+
+BENCH_SUITE(frame_exchange)
+{
+    for (uint8_t s = 0; s < sizeof(FRAME_SIZES) / sizeof(FRAME_SIZES[0]); s++)
+    {
+        benchFrames(FRAME_SIZES[s]);
+    }
+}
@@ -0,0 +1,110 @@
+/*
+ * LinkedList benchmarks.
+ */
+#include <vector>
+#include "Bench.h"
+#include "LinkedList.h"
+
+// push_back() checks for duplicates with a list walk, so the list sizes
+// stay small enough to finish in reasonable time.
+static const uint32_t LIST_CAPACITIES[] = {16, 256, 4096};
+
+template <uint32_t Size>
+static void benchLinkedList(uint32_t capacity)
+{
+    typedef BenchElement<Size> Element;
+    std::vector<ListEntry<Element> > entries(capacity);
+    LinkedList<Element> list;
+    uint32_t sink = 0;
+
+    struct Reset
+    {
+        static void entries(std::vector<ListEntry<Element> > &e)
+        {
+            for (uint32_t i = 0; i < e.size(); i++)
+                e[i].reset_next();
+        }
+    };
+
+    BenchCase pushBack = {"LinkedList", "push_back", Size, capacity, 1};
+    benchRun(pushBack, capacity,
+             [&]() {
+                 Reset::entries(entries);
+                 list = LinkedList<Element>();
+             },
+             [&](uint64_t i) { list.push_back(entries[i % capacity]); });
+
+    BenchCase insert = {"LinkedList", "insert_middle", Size, capacity, 1};
+    benchRun(insert, capacity,
+             [&]() {
+                 Reset::entries(entries);
+                 list = LinkedList<Element>();
+             },
+             [&](uint64_t i) { list.insert(list.size() / 2, entries[i % capacity]); });
+
+    BenchCase at = {"LinkedList", "at", Size, capacity, 1};
+    benchRun(at, [&](uint64_t i) { sink += list.at((uint16_t)(i % capacity))->bytes[0]; });
+
+    BenchCase iterate = {"LinkedList", "iterate", Size, capacity, 1};
+    typename LinkedList<Element>::iterator it = list.begin();
+    benchRun(iterate, [&](uint64_t) {
+        sink += it->bytes[0];
+        if (++it == list.end())
+            it = list.begin();
+    });
+
+    BenchCase size = {"LinkedList", "size", Size, capacity, 1};
+    benchRun(size, [&](uint64_t) { sink += list.size(); });
+    benchSink(sink);
+}
+
+template <uint32_t Size>
+static void benchLinkedListCapacities(void)
+{
+    for (uint8_t c = 0; c < sizeof(LIST_CAPACITIES) / sizeof(LIST_CAPACITIES[0]); c++)
+    {
+        benchLinkedList<Size>(LIST_CAPACITIES[c]);
+    }
+}
+
+BENCH_SUITE(linked_list)
+{
+    benchLinkedListCapacities<1>();
+    benchLinkedListCapacities<8>();
+    benchLinkedListCapacities<64>();
+    benchLinkedListCapacities<256>();
+
+    // Concurrent read-only walks over disjoint segments
+    const uint32_t capacity = 4096;
+    std::vector<ListEntry<uint32_t> > entries(capacity);
+    LinkedList<uint32_t> list;
+    std::vector<LinkedList<uint32_t>::iterator> first, last;
+
+    for (uint32_t i = 0; i < capacity; i++)
+    {
+        entries[i].data(i);
+        list.push_back(entries[i]);
+    }
+
+    for (uint8_t t = 0; t < BENCH_THREAD_VARIANTS; t++)
+    {
+        uint32_t threads = BENCH_THREADS[t];
+        first.clear();
+        last.clear();
+        list.for_each_chunk((uint16_t)threads, [&](LinkedList<uint32_t>::iterator a,
+                                                   LinkedList<uint32_t>::iterator b) {
+            first.push_back(a);
+            last.push_back(b);
+        });
+
+        BenchCase chunks = {"LinkedList", "for_each_chunk_walk", sizeof(uint32_t), capacity, threads};
+        std::vector<LinkedList<uint32_t>::iterator> cursor(first);
+        std::atomic<uint32_t> sink(0);
+        benchRunThreads(chunks, [&](uint32_t thread, uint64_t) {
+            if (*cursor[thread] == 0xFFFFFFFFu)
+                sink++;
+            if (++cursor[thread] == last[thread])
+                cursor[thread] = first[thread];
+        });
+    }
+}
@@ -0,0 +1,197 @@
+/*
+ * Host benchmark driver.
+ *
+ * Usage: buffer_bench [--quick] [--filter <suite>] [--json <file>]
+ *
+ *   --quick   run a reduced number of operations per case
+ *   --filter  only run suites whose name contains the given text
+ *   --json    write all results as JSON to the given file ("-" for stdout)
+ */
+#include <atomic>
+#include <new>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include "Bench.h"
+
+#ifndef BUFFER_VERSION
+#define BUFFER_VERSION "unknown"
+#endif
+
+static std::atomic<uint64_t> g_allocations(0);
+
+void *operator new(size_t size)
+{
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    void *p = malloc(size != 0 ? size : 1);
+    if (p == NULL)
+        throw std::bad_alloc();
+    return p;
+}
+
+void *operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void *p) noexcept
+{
+    free(p);
+}
+
+void operator delete[](void *p) noexcept
+{
+    free(p);
+}
+
+void operator delete(void *p, size_t) noexcept
+{
+    free(p);
+}
+
+void operator delete[](void *p, size_t) noexcept
+{
+    free(p);
+}
+
+struct RegisteredSuite
+{
+    const char *name;
+    BenchSuiteFunction function;
+};
+
+static std::vector<RegisteredSuite> &suites(void)
+{
+    static std::vector<RegisteredSuite> registered;
+    return registered;
+}
+
+static std::vector<BenchResult> &results(void)
+{
+    static std::vector<BenchResult> collected;
+    return collected;
+}
+
+static volatile uint64_t g_sink = 0;
+static uint64_t g_operations = 1u << 18;
+static FILE *g_table = stdout;
+
+BenchSuite::BenchSuite(const char *name, BenchSuiteFunction function)
+{
+    RegisteredSuite suite = {name, function};
+    suites().push_back(suite);
+}
+
+uint64_t benchOperations(void)
+{
+    return g_operations;
+}
+
+uint64_t benchAllocations(void)
+{
+    return g_allocations.load(std::memory_order_relaxed);
+}
+
+void benchSink(uint64_t value)
+{
+    g_sink = value;
+}
+
+void benchCheck(bool ok, const char *what)
+{
+    if (!ok)
+    {
+        fprintf(stderr, "check failed: %s\n", what);
+        exit(1);
+    }
+}
+
+void benchReport(const BenchResult &r)
+{
+    double opsPerSec = r.seconds > 0 ? (double)r.operations / r.seconds : 0;
+    double nsPerOp = r.operations > 0 ? r.seconds * 1e9 / (double)r.operations : 0;
+
+    fprintf(g_table, "%-12s %-22s %5u B %7u cap %2u thr %12.0f ops/s %9.2f ns/op  p50 %6llu  p99 %6llu  p999 %7llu  allocs %llu\n",
+           r.params.container, r.params.operation, r.params.elementSize, r.params.capacity,
+           r.params.threads, opsPerSec, nsPerOp, (unsigned long long)r.p50,
+           (unsigned long long)r.p99, (unsigned long long)r.p999,
+           (unsigned long long)r.allocations);
+    fflush(g_table);
+    results().push_back(r);
+}
+
+static void writeJson(FILE *f)
+{
+    fprintf(f, "{\n  \"version\": \"%s\",\n  \"operations\": %llu,\n  \"results\": [\n",
+            BUFFER_VERSION, (unsigned long long)g_operations);
+    for (size_t i = 0; i < results().size(); i++)
+    {
+        const BenchResult &r = results()[i];
+        double opsPerSec = r.seconds > 0 ? (double)r.operations / r.seconds : 0;
+        double nsPerOp = r.operations > 0 ? r.seconds * 1e9 / (double)r.operations : 0;
+
+        fprintf(f,
+                "    {\"container\": \"%s\", \"operation\": \"%s\", \"element_size\": %u, "
+                "\"capacity\": %u, \"threads\": %u, \"operations\": %llu, "
+                "\"ops_per_sec\": %.1f, \"ns_per_op\": %.3f, \"p50_ns\": %llu, "
+                "\"p99_ns\": %llu, \"p999_ns\": %llu, \"max_ns\": %llu, \"allocations\": %llu}%s\n",
+                r.params.container, r.params.operation, r.params.elementSize, r.params.capacity,
+                r.params.threads, (unsigned long long)r.operations, opsPerSec, nsPerOp,
+                (unsigned long long)r.p50, (unsigned long long)r.p99,
+                (unsigned long long)r.p999, (unsigned long long)r.max,
+                (unsigned long long)r.allocations, i + 1 < results().size() ? "," : "");
+    }
+    fprintf(f, "  ]\n}\n");
+}
+
+int main(int argc, char **argv)
+{
+    const char *filter = NULL;
+    const char *json = NULL;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--quick") == 0)
+        {
+            g_operations = 1u << 12;
+        }
+        else if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc)
+        {
+            filter = argv[++i];
+        }
+        else if (strcmp(argv[i], "--json") == 0 && i + 1 < argc)
+        {
+            json = argv[++i];
+            if (strcmp(json, "-") == 0)
+                g_table = stderr;
+        }
+        else
+        {
+            fprintf(stderr, "usage: %s [--quick] [--filter <suite>] [--json <file>]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    for (size_t i = 0; i < suites().size(); i++)
+    {
+        if (filter == NULL || strstr(suites()[i].name, filter) != NULL)
+        {
+            suites()[i].function();
+        }
+    }
+
+    if (json != NULL)
+    {
+        FILE *f = strcmp(json, "-") == 0 ? stdout : fopen(json, "w");
+        if (f == NULL)
+        {
+            fprintf(stderr, "cannot open %s\n", json);
+            return 1;
+        }
+        writeJson(f);
+        if (f != stdout)
+            fclose(f);
+    }
+    return 0;
+}
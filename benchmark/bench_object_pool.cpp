@@ -0,0 +1,125 @@
+/*
+ * ObjectPool benchmarks against new/delete. Every thread keeps the objects
+ * of its last POOL_HELD operations alive, one operation allocates an object
+ * and frees the oldest one. The "fifo" cases pass a 64 byte message through
+ * a FiFo, either as a copy or as the 16 bit index of a pool object.
+ */
+#include <memory>
+#include <vector>
+#include "Bench.h"
+#include "FiFo.h"
+#include "ObjectPool.h"
+
+static const uint16_t POOL_CAPACITY = 4096;
+static const uint16_t POOL_HELD = 16;
+static const uint16_t POOL_FIFO_DEPTH = 64;
+
+struct PoolMessage
+{
+    uint32_t id;
+    uint8_t payload[60];
+
+    PoolMessage() : id(0) {}
+    explicit PoolMessage(uint32_t value) : id(value) { payload[0] = (uint8_t)value; }
+};
+
+// Objects held by one thread, on their own cache lines
+struct PoolHeld
+{
+    alignas(FIFO_CACHE_LINE_SIZE) PoolMessage *pointers[POOL_HELD];
+    uint16_t indices[POOL_HELD];
+    uint64_t sink;
+};
+
+static void benchPoolFiFo(ObjectPool<PoolMessage> &pool)
+{
+    std::vector<uint8_t> copyStorage(POOL_FIFO_DEPTH * sizeof(PoolMessage));
+    std::vector<uint8_t> indexStorage(POOL_FIFO_DEPTH * sizeof(uint16_t));
+    FiFo<PoolMessage> copies;
+    FiFo<uint16_t> indices;
+    uint64_t sink = 0;
+
+    copies.initBuffer(&copyStorage[0], (uint16_t)copyStorage.size());
+    BenchCase copy = {"FiFo", "fifo_copy", sizeof(PoolMessage), POOL_FIFO_DEPTH, 1};
+    benchRun(copy, [&](uint64_t i) {
+        PoolMessage message((uint32_t)i);
+        copies.write(&message);
+        sink += copies.read().id;
+    });
+
+    indices.initBuffer(&indexStorage[0], (uint16_t)indexStorage.size());
+    BenchCase index = {"ObjectPool", "fifo_index", sizeof(PoolMessage), POOL_FIFO_DEPTH, 1};
+    benchRun(index, [&](uint64_t i) {
+        uint16_t slot = pool.acquire((uint32_t)i);
+        indices.write(&slot);
+        slot = indices.read();
+        sink += pool.get(slot)->id;
+        pool.release(slot);
+    });
+    benchSink(sink);
+}
+
+BENCH_SUITE(object_pool)
+{
+    typedef ObjectPoolCache<PoolMessage> Cache;
+    ObjectPool<PoolMessage> pool(POOL_CAPACITY);
+    std::vector<PoolHeld> held(BENCH_THREADS[BENCH_THREAD_VARIANTS - 1]);
+    uint64_t sink = 0;
+
+    for (uint8_t v = 0; v < BENCH_THREAD_VARIANTS; v++)
+    {
+        uint32_t threads = BENCH_THREADS[v];
+
+        for (uint32_t t = 0; t < threads; t++)
+        {
+            for (uint16_t k = 0; k < POOL_HELD; k++)
+                held[t].pointers[k] = new PoolMessage(k);
+        }
+        BenchCase heap = {"new_delete", "alloc_free", sizeof(PoolMessage), 0, threads};
+        benchRunThreads(heap, [&](uint32_t t, uint64_t i) {
+            PoolMessage *&slot = held[t].pointers[i % POOL_HELD];
+            held[t].sink += slot->id;
+            delete slot;
+            slot = new PoolMessage((uint32_t)i);
+        });
+        for (uint32_t t = 0; t < threads; t++)
+        {
+            for (uint16_t k = 0; k < POOL_HELD; k++)
+                delete held[t].pointers[k];
+        }
+
+        for (uint32_t t = 0; t < threads; t++)
+        {
+            for (uint16_t k = 0; k < POOL_HELD; k++)
+                held[t].indices[k] = pool.acquire(k);
+        }
+        BenchCase shared = {"ObjectPool", "alloc_free", sizeof(PoolMessage), POOL_CAPACITY, threads};
+        benchRunThreads(shared, [&](uint32_t t, uint64_t i) {
+            uint16_t &slot = held[t].indices[i % POOL_HELD];
+            held[t].sink += pool.get(slot)->id;
+            pool.release(slot);
+            slot = pool.acquire((uint32_t)i);
+        });
+
+        // One cache per thread, created outside the measured operations
+        std::vector<std::unique_ptr<Cache> > caches;
+        for (uint32_t t = 0; t < threads; t++)
+            caches.emplace_back(new Cache(pool));
+        BenchCase cached = {"ObjectPool", "alloc_free_cached", sizeof(PoolMessage), POOL_CAPACITY, threads};
+        benchRunThreads(cached, [&](uint32_t t, uint64_t i) {
+            uint16_t &slot = held[t].indices[i % POOL_HELD];
+            held[t].sink += pool.get(slot)->id;
+            caches[t]->release(slot);
+            slot = caches[t]->acquire((uint32_t)i);
+        });
+        caches.clear();
+        for (uint32_t t = 0; t < threads; t++)
+        {
+            for (uint16_t k = 0; k < POOL_HELD; k++)
+                pool.release(held[t].indices[k]);
+            sink += held[t].sink;
+        }
+    }
+    benchSink(sink);
+    benchPoolFiFo(pool);
+}
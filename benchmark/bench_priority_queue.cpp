@@ -0,0 +1,133 @@
+/*
+ * PriorityQueue benchmarks against the multi-FiFo workaround: one FiFo per
+ * priority level, read() scans the levels from the most urgent one. The
+ * queues are half filled, one operation writes one element with a random
+ * level and reads the most urgent one.
+ */
+#include <vector>
+#include "Bench.h"
+#include "FiFo.h"
+#include "PriorityQueue.h"
+
+static const uint8_t PRIORITY_LEVELS = 8;
+// Queue storage is sized in 16 bit bytes, so the stable queue ends below 5461
+static const uint16_t PRIORITY_CAPACITIES[] = {64, 1024, 4096};
+static const uint16_t PRIORITY_BATCH = 32;
+
+struct PriorityMessage
+{
+    uint32_t level;
+    uint32_t payload;
+
+    bool operator<(const PriorityMessage &other) const { return level < other.level; }
+};
+
+static uint32_t priorityRandom(uint32_t &seed)
+{
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+    return seed;
+}
+
+template <uint8_t Arity, bool Stable>
+static void benchPriorityQueue(const char *write_read, const char *range_drain, uint16_t capacity)
+{
+    typedef PriorityQueue<PriorityMessage, PriorityQueueLess<PriorityMessage>, Arity, Stable> Queue;
+    std::vector<uint8_t> storage(PRIORITY_QUEUE_CALCULATE_BUFFERSIZE(capacity, PriorityMessage, Stable));
+    PriorityMessage batch[PRIORITY_BATCH];
+    Queue queue;
+    uint32_t seed = 2463534242u;
+    uint32_t sink = 0;
+
+    queue.initBuffer(&storage[0], (uint16_t)storage.size());
+    while (queue.size() < capacity / 2)
+    {
+        PriorityMessage m = {priorityRandom(seed) % PRIORITY_LEVELS, 0};
+        queue.write(m);
+    }
+
+    BenchCase steady = {"PriorityQueue", write_read, sizeof(PriorityMessage), capacity, 1};
+    benchRun(steady, [&](uint64_t i) {
+        PriorityMessage m = {priorityRandom(seed) % PRIORITY_LEVELS, (uint32_t)i};
+        queue.write(m);
+        sink += queue.read().payload;
+    });
+
+    // One operation adds PRIORITY_BATCH elements and reads as many
+    BenchCase range = {"PriorityQueue", range_drain, sizeof(PriorityMessage), capacity, 1};
+    benchRun(range, [&](uint64_t i) {
+        for (uint16_t k = 0; k < PRIORITY_BATCH; k++)
+        {
+            batch[k].level = priorityRandom(seed) % PRIORITY_LEVELS;
+            batch[k].payload = (uint32_t)i;
+        }
+        queue.push_range(batch, PRIORITY_BATCH);
+        for (uint16_t k = 0; k < PRIORITY_BATCH; k++)
+            sink += queue.read().payload;
+    });
+    benchSink(sink);
+}
+
+static void benchMultiFiFo(uint16_t capacity)
+{
+    // Every level can hold all elements
+    uint16_t levelBytes = (uint16_t)(capacity * sizeof(PriorityMessage));
+    std::vector<uint8_t> storage((uint32_t)PRIORITY_LEVELS * levelBytes);
+    FiFo<PriorityMessage> fifos[PRIORITY_LEVELS];
+    uint32_t seed = 2463534242u;
+    uint32_t sink = 0;
+    uint16_t held = 0;
+
+    for (uint8_t l = 0; l < PRIORITY_LEVELS; l++)
+        fifos[l].initBuffer(&storage[(uint32_t)l * levelBytes], levelBytes);
+    while (held < capacity / 2)
+    {
+        PriorityMessage m = {priorityRandom(seed) % PRIORITY_LEVELS, 0};
+        fifos[m.level].write(&m);
+        held++;
+    }
+
+    BenchCase steady = {"FiFo[8]", "write_read", sizeof(PriorityMessage), capacity, 1};
+    benchRun(steady, [&](uint64_t i) {
+        PriorityMessage m = {priorityRandom(seed) % PRIORITY_LEVELS, (uint32_t)i};
+        fifos[m.level].write(&m);
+        for (uint8_t l = 0; l < PRIORITY_LEVELS; l++)
+        {
+            if (fifos[l].dataAvailable())
+            {
+                sink += fifos[l].read().payload;
+                break;
+            }
+        }
+    });
+
+    BenchCase range = {"FiFo[8]", "range_drain_32", sizeof(PriorityMessage), capacity, 1};
+    benchRun(range, [&](uint64_t i) {
+        for (uint16_t k = 0; k < PRIORITY_BATCH; k++)
+        {
+            PriorityMessage m = {priorityRandom(seed) % PRIORITY_LEVELS, (uint32_t)i};
+            fifos[m.level].write(&m);
+        }
+        uint8_t l = 0;
+        for (uint16_t k = 0; k < PRIORITY_BATCH; k++)
+        {
+            while (!fifos[l].dataAvailable())
+                l++;
+            sink += fifos[l].read().payload;
+        }
+    });
+    benchSink(sink);
+}
+
+BENCH_SUITE(priority_queue)
+{
+    for (uint8_t c = 0; c < sizeof(PRIORITY_CAPACITIES) / sizeof(PRIORITY_CAPACITIES[0]); c++)
+    {
+        uint16_t capacity = PRIORITY_CAPACITIES[c];
+        benchPriorityQueue<2, false>("write_read_binary", "range_drain_32_binary", capacity);
+        benchPriorityQueue<4, false>("write_read", "range_drain_32", capacity);
+        benchPriorityQueue<4, true>("write_read_stable", "range_drain_32_stable", capacity);
+        benchMultiFiFo(capacity);
+    }
+}
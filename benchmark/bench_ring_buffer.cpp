@@ -0,0 +1,76 @@
+/*
+ * RingBuffer benchmarks.
+ */
+#include "Bench.h"
+#include "RingBuffer.h"
+
+// Offsets are 16 bit signed, so the largest usable size is 32767
+static const uint32_t RING_CAPACITIES[] = {16, 256, 4096, 32767};
+
+template <uint32_t Size>
+static void benchRingBuffer(uint32_t capacity)
+{
+    typedef BenchElement<Size> Element;
+    RingBuffer<Element> ring((uint16_t)capacity);
+    Element element = Element();
+    uint32_t sink = 0;
+
+    BenchCase add = {"RingBuffer", "add", Size, capacity, 1};
+    benchRun(add, [&](uint64_t) { ring.add(element); });
+
+    BenchCase addStats = {"RingBuffer", "add_stats", Size, capacity, 1};
+    RingBuffer<Element, BufferStats> counted((uint16_t)capacity);
+    benchRun(addStats, [&](uint64_t) { counted.add(element); });
+
+    BenchCase addIndex = {"RingBuffer", "add_index", Size, capacity, 1};
+    benchRun(addIndex, [&](uint64_t i) { ring.add((uint16_t)(i % capacity), element); });
+
+    BenchCase at = {"RingBuffer", "at", Size, capacity, 1};
+    benchRun(at, [&](uint64_t i) { sink += ring.at(-(int16_t)(i % capacity)).bytes[0]; });
+
+    BenchCase atIndex = {"RingBuffer", "atIndex", Size, capacity, 1};
+    benchRun(atIndex, [&](uint64_t i) { sink += ring.atIndex((uint16_t)(i % capacity)).bytes[0]; });
+
+    BenchCase current = {"RingBuffer", "current", Size, capacity, 1};
+    benchRun(current, [&](uint64_t) { sink += ring.current().bytes[0]; });
+
+    BenchCase moveNext = {"RingBuffer", "moveNext", Size, capacity, 1};
+    benchRun(moveNext, [&](uint64_t) { ring.moveNext(); });
+
+    BenchCase movePrevious = {"RingBuffer", "movePrevious", Size, capacity, 1};
+    benchRun(movePrevious, [&](uint64_t) { ring.movePrevious(); });
+    benchSink(sink);
+}
+
+template <uint32_t Size>
+static void benchRingBufferCapacities(void)
+{
+    for (uint8_t c = 0; c < sizeof(RING_CAPACITIES) / sizeof(RING_CAPACITIES[0]); c++)
+    {
+        benchRingBuffer<Size>(RING_CAPACITIES[c]);
+    }
+}
+
+BENCH_SUITE(ring_buffer)
+{
+    benchRingBufferCapacities<1>();
+    benchRingBufferCapacities<8>();
+    benchRingBufferCapacities<64>();
+    benchRingBufferCapacities<256>();
+
+    // Concurrent readers of one buffer
+    const uint32_t capacity = 4096;
+    RingBuffer<uint32_t> ring((uint16_t)capacity);
+    for (uint32_t i = 0; i < capacity; i++)
+        ring.add(i);
+
+    for (uint8_t t = 0; t < BENCH_THREAD_VARIANTS; t++)
+    {
+        BenchCase shared = {"RingBuffer", "shared_at", sizeof(uint32_t), capacity, BENCH_THREADS[t]};
+        std::atomic<uint32_t> sink(0);
+        benchRunThreads(shared, [&](uint32_t, uint64_t i) {
+            if (ring.at(-(int16_t)(i % capacity)) == 0xFFFFFFFFu)
+                sink++;
+        });
+    }
+}
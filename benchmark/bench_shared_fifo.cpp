@@ -0,0 +1,133 @@
+/*
+ * SharedFiFo benchmarks between two processes against a Unix socketpair.
+ * The parent process runs the measured side, a forked child the other one.
+ * "roundtrip" sends one message and waits for the echo of the child, so the
+ * latency columns show the round trip time. "stream" sends one message per
+ * operation while the child drains them, waiting only when the FiFo is full.
+ */
+#if defined(__linux__)
+
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "Bench.h"
+#include "SharedFiFo.h"
+
+static const uint32_t SHARED_FIFO_CAPACITY = 4096;
+static const uint32_t SHARED_FIFO_DRAIN = 256;
+
+/**
+ * @brief Child side of a SharedFiFo case, echoes or drains until closed.
+ */
+static void sharedChild(SharedFiFo<uint64_t> &ping, SharedFiFo<uint64_t> &pong, bool echo)
+{
+    uint64_t messages[SHARED_FIFO_DRAIN];
+    while (ping.waitForData())
+    {
+        uint32_t n = ping.read(messages, SHARED_FIFO_DRAIN);
+        for (uint32_t k = 0; echo && k < n; k++)
+        {
+            while (!pong.write(messages[k]) && pong.waitForSpace())
+                ;
+        }
+    }
+    _exit(0);
+}
+
+static void benchSharedFiFo(const char *operation, bool echo)
+{
+    SharedFiFo<uint64_t> ping;
+    SharedFiFo<uint64_t> pong;
+    uint64_t sink = 0;
+
+    if (!ping.create(NULL, SHARED_FIFO_CAPACITY) || !pong.create(NULL, SHARED_FIFO_CAPACITY))
+        return;
+
+    pid_t child = fork();
+    if (child == 0)
+        sharedChild(ping, pong, echo);
+    if (child < 0)
+        return;
+
+    BenchCase params = {"SharedFiFo", operation, sizeof(uint64_t), SHARED_FIFO_CAPACITY, 2};
+    benchRun(params, [&](uint64_t i) {
+        while (!ping.write(i) && ping.waitForSpace())
+            ;
+        if (echo)
+        {
+            uint64_t reply = 0;
+            while (!pong.read(reply) && pong.waitForData())
+                ;
+            sink += reply;
+        }
+    });
+    ping.close();
+    waitpid(child, NULL, 0);
+    benchSink(sink);
+}
+
+/**
+ * @brief Child side of a socketpair case, echoes or drains until EOF.
+ */
+static void socketChild(int fd, bool echo)
+{
+    uint64_t messages[SHARED_FIFO_DRAIN];
+    ssize_t got;
+    while ((got = read(fd, messages, sizeof(messages))) > 0)
+    {
+        if (echo && write(fd, messages, (size_t)got) != got)
+            break;
+    }
+    _exit(0);
+}
+
+static void benchSocket(const char *operation, bool echo)
+{
+    uint64_t sink = 0;
+    int fds[2];
+
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0)
+        return;
+
+    pid_t child = fork();
+    if (child == 0)
+    {
+        close(fds[0]);
+        socketChild(fds[1], echo);
+    }
+    close(fds[1]);
+    if (child < 0)
+    {
+        close(fds[0]);
+        return;
+    }
+
+    BenchCase params = {"socketpair", operation, sizeof(uint64_t), 0, 2};
+    benchRun(params, [&](uint64_t i) {
+        if (write(fds[0], &i, sizeof(i)) == (ssize_t)sizeof(i) && echo)
+        {
+            uint64_t reply = 0;
+            size_t have = 0;
+            ssize_t got = 1;
+            while (have < sizeof(reply) && got > 0)
+            {
+                got = read(fds[0], (uint8_t *)&reply + have, sizeof(reply) - have);
+                have += got > 0 ? (size_t)got : 0;
+            }
+            sink += reply;
+        }
+    });
+    close(fds[0]);
+    waitpid(child, NULL, 0);
+    benchSink(sink);
+}
+
+BENCH_SUITE(shared_fifo)
+{
+    benchSharedFiFo("roundtrip", true);
+    benchSocket("roundtrip", true);
+    benchSharedFiFo("stream", false);
+    benchSocket("stream", false);
+}
+
+#endif
@@ -0,0 +1,85 @@
+/*
+ * SortedList benchmarks, up to 100k entries.
+ */
+#include <vector>
+#include "Bench.h"
+#include "SortedList.h"
+
+static const uint32_t SORTED_CAPACITIES[] = {1000, 10000, 100000};
+
+template <uint32_t Size>
+struct Deadline
+{
+    uint32_t due;
+    uint8_t payload[Size];
+
+    bool operator<(const Deadline &other) const { return due < other.due; }
+};
+
+static uint32_t xorshift(uint32_t &s)
+{
+    s ^= s << 13;
+    s ^= s >> 17;
+    s ^= s << 5;
+    return s;
+}
+
+template <uint32_t Size>
+static void benchSortedList(uint32_t capacity)
+{
+    typedef Deadline<Size> Key;
+    typedef SortedList<Key> List;
+    std::vector<typename List::Entry> pool(capacity);
+    std::vector<Key> keys(capacity);
+    List list;
+    uint32_t seed = 12345u;
+    uint32_t sink = 0;
+
+    for (uint32_t i = 0; i < capacity; i++)
+    {
+        keys[i] = Key();
+        keys[i].due = xorshift(seed);
+    }
+
+    BenchCase insert = {"SortedList", "insert_sorted", (uint32_t)sizeof(Key), capacity, 1};
+    benchRun(insert, capacity, [&]() { list.initBuffer(&pool[0], capacity); },
+             [&](uint64_t i) { list.insert_sorted(keys[i % capacity]); });
+
+    BenchCase find = {"SortedList", "find", (uint32_t)sizeof(Key), capacity, 1};
+    benchRun(find, [&](uint64_t i) { sink += list.find(keys[i % capacity]) != NULL; });
+
+    BenchCase lowerBound = {"SortedList", "lower_bound", (uint32_t)sizeof(Key), capacity, 1};
+    benchRun(lowerBound, [&](uint64_t i) {
+        Key key = keys[i % capacity];
+        key.due++;
+        sink += list.lower_bound(key) != NULL;
+    });
+
+    // Ranges hold 16 entries on average
+    BenchCase scan = {"SortedList", "scan_16", (uint32_t)sizeof(Key), capacity, 1};
+    uint32_t width = (uint32_t)(0xFFFFFFFFull * 16 / capacity);
+    benchRun(scan, [&](uint64_t i) {
+        Key to = keys[i % capacity];
+        to.due += width;
+        sink += list.scan(keys[i % capacity], to, [&](Key &k) { sink += k.due; });
+    });
+
+    BenchCase erase = {"SortedList", "erase", (uint32_t)sizeof(Key), capacity, 1};
+    benchRun(erase, capacity,
+             [&]() {
+                 list.initBuffer(&pool[0], capacity);
+                 for (uint32_t i = 0; i < capacity; i++)
+                     list.insert_sorted(keys[i]);
+             },
+             [&](uint64_t i) { sink += list.erase(keys[i % capacity]); });
+    benchSink(sink);
+}
+
+BENCH_SUITE(sorted_list)
+{
+    for (uint8_t c = 0; c < sizeof(SORTED_CAPACITIES) / sizeof(SORTED_CAPACITIES[0]); c++)
+    {
+        benchSortedList<4>(SORTED_CAPACITIES[c]);
+        benchSortedList<60>(SORTED_CAPACITIES[c]);
+    }
+}
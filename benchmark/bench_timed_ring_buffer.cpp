@@ -0,0 +1,124 @@
+/*
+ * TimedRingBuffer benchmarks against scanning a RingBuffer of timestamped
+ * samples backwards from the newest one. The buffers are full and wrapped,
+ * samples are 1 ms apart. "range_64" sums the samples of a 64 ms window at
+ * a random position in the history, "latest_before" looks up the sample at
+ * a random point in time. Before timing, both queries are checked against
+ * the scan, including the whole history split into two spans and an empty
+ * range with from > to.
+ */
+#include "Bench.h"
+#include "RingBuffer.h"
+#include "TimedRingBuffer.h"
+
+static const uint16_t TIMED_CAPACITIES[] = {1024, 32767};
+static const uint16_t TIMED_WINDOW = 64;
+
+struct TimedSample
+{
+    uint64_t time;
+    int32_t value;
+};
+
+static void benchTimed(uint16_t capacity)
+{
+    TimedRingBuffer<int32_t> timed(capacity);
+    RingBuffer<TimedSample> plain(capacity);
+    uint32_t seed = 2463534242u;
+    uint64_t now = 0;
+    uint64_t sink = 0;
+
+    // Wrap both buffers so the history spans the end of the storage
+    for (uint32_t i = 0; i < (uint32_t)capacity + capacity / 3; i++)
+    {
+        TimedSample sample = {++now, (int32_t)i};
+        timed.add(sample.time, sample.value);
+        plain.add(sample);
+    }
+
+    auto pick = [&]() -> uint64_t {
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+        return now - capacity + 1 + seed % (capacity - TIMED_WINDOW);
+    };
+
+    auto timedRange = [&](uint64_t from, uint64_t to) -> uint64_t {
+        TimedRingBuffer<int32_t>::Range r = timed.range(from, to);
+        uint64_t sum = 0;
+        for (uint16_t k = 0; k < r.first.count; k++)
+            sum += (uint32_t)r.first.values[k];
+        for (uint16_t k = 0; k < r.second.count; k++)
+            sum += (uint32_t)r.second.values[k];
+        return sum;
+    };
+
+    auto scanRange = [&](uint64_t from, uint64_t to) -> uint64_t {
+        uint64_t sum = 0;
+        for (int16_t k = -1; k >= -(int16_t)capacity; k--)
+        {
+            const TimedSample &sample = plain.at(k);
+            if (sample.time < from)
+                break;
+            if (sample.time <= to)
+                sum += (uint32_t)sample.value;
+        }
+        return sum;
+    };
+
+    auto timedLatest = [&](uint64_t t) -> uint64_t {
+        const int32_t *value = timed.latest_before(t);
+        return value != NULL ? (uint32_t)*value : 0;
+    };
+
+    auto scanLatest = [&](uint64_t t) -> uint64_t {
+        for (int16_t k = -1; k >= -(int16_t)capacity; k--)
+        {
+            const TimedSample &sample = plain.at(k);
+            if (sample.time <= t)
+                return (uint32_t)sample.value;
+        }
+        return 0;
+    };
+
+    benchCheck(timed.range(0, now).second.count > 0, "TimedRingBuffer history is not wrapped");
+    benchCheck(timedRange(0, now) == scanRange(0, now), "TimedRingBuffer range over both spans");
+    benchCheck(timed.range(now, now - 1).size() == 0, "TimedRingBuffer range with from > to");
+    for (uint16_t k = 0; k < 256; k++)
+    {
+        uint64_t from = pick();
+        benchCheck(timedRange(from, from + TIMED_WINDOW - 1) == scanRange(from, from + TIMED_WINDOW - 1),
+                   "TimedRingBuffer range_64");
+        benchCheck(timedLatest(from) == scanLatest(from), "TimedRingBuffer latest_before");
+    }
+
+    BenchCase range = {"TimedRingBuffer", "range_64", sizeof(int32_t), capacity, 1};
+    benchRun(range, [&](uint64_t) {
+        uint64_t from = pick();
+        sink += timedRange(from, from + TIMED_WINDOW - 1);
+    });
+
+    BenchCase scan = {"RingBuffer", "range_64", sizeof(TimedSample), capacity, 1};
+    benchRun(scan, [&](uint64_t) {
+        uint64_t from = pick();
+        sink += scanRange(from, from + TIMED_WINDOW - 1);
+    });
+
+    BenchCase latest = {"TimedRingBuffer", "latest_before", sizeof(int32_t), capacity, 1};
+    benchRun(latest, [&](uint64_t) { sink += timedLatest(pick()); });
+
+    BenchCase latestScan = {"RingBuffer", "latest_before", sizeof(TimedSample), capacity, 1};
+    benchRun(latestScan, [&](uint64_t) { sink += scanLatest(pick()); });
+
+    BenchCase add = {"TimedRingBuffer", "add", sizeof(int32_t), capacity, 1};
+    benchRun(add, [&](uint64_t i) { timed.add(++now, (int32_t)i); });
+    benchSink(sink);
+}
+
+BENCH_SUITE(timed_ring_buffer)
+{
+    for (uint8_t c = 0; c < sizeof(TIMED_CAPACITIES) / sizeof(TIMED_CAPACITIES[0]); c++)
+    {
+        benchTimed(TIMED_CAPACITIES[c]);
+    }
+}
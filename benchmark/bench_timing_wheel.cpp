@@ -0,0 +1,154 @@
+/*
+ * TimingWheel benchmarks against a binary heap scheduler (std::priority_queue
+ * with lazy cancellation) holding about one million timers. "schedule_fire"
+ * schedules one timer per operation and advances the clock by one tick every
+ * TIMER_OPS_PER_TICK operations, firing the expired timers. "reschedule"
+ * moves a random scheduled timer to a new expiry, like a connection timeout
+ * which is refreshed on traffic; the heap pushes a new entry and drops the
+ * stale one when it surfaces.
+ */
+#include <functional>
+#include <queue>
+#include <utility>
+#include <vector>
+#include "Bench.h"
+#include "TimingWheel.h"
+
+static const uint32_t TIMER_COUNT = 1u << 20;
+static const uint32_t TIMER_POOL = TIMER_COUNT + (TIMER_COUNT >> 2);
+static const uint32_t TIMER_MAX_DELAY = 1u << 16;
+static const uint32_t TIMER_OPS_PER_TICK = 2 * TIMER_COUNT / TIMER_MAX_DELAY;
+
+static uint32_t timerRandom(uint32_t &seed)
+{
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+    return seed;
+}
+
+static uint64_t timerDelay(uint32_t &seed) { return 1 + timerRandom(seed) % (TIMER_MAX_DELAY - 1); }
+
+static void benchWheel(void)
+{
+    typedef TimingWheel<uint32_t> Wheel;
+    std::vector<Wheel::Entry> timers(TIMER_POOL);
+    std::vector<uint32_t> idle;
+    Wheel wheel;
+    uint32_t seed = 2463534242u;
+    uint64_t sink = 0;
+
+    idle.reserve(TIMER_POOL);
+    for (uint32_t k = TIMER_POOL; k-- > 0;)
+    {
+        timers[k].data(k);
+        idle.push_back(k);
+    }
+    for (uint32_t k = 0; k < TIMER_COUNT; k++)
+    {
+        wheel.schedule(timers[idle.back()], timerDelay(seed));
+        idle.pop_back();
+    }
+
+    auto fire = [&](Wheel::Entry &timer) {
+        idle.push_back(*timer.data());
+        sink += timer.expires();
+    };
+
+    BenchCase scheduleFire = {"TimingWheel", "schedule_fire", sizeof(Wheel::Entry), TIMER_COUNT, 1};
+    benchRun(scheduleFire, [&](uint64_t i) {
+        if (!idle.empty())
+        {
+            wheel.schedule(timers[idle.back()], wheel.now() + timerDelay(seed));
+            idle.pop_back();
+        }
+        if (i % TIMER_OPS_PER_TICK == 0)
+            wheel.advance(wheel.now() + 1, fire);
+    });
+
+    BenchCase reschedule = {"TimingWheel", "reschedule", sizeof(Wheel::Entry), TIMER_COUNT, 1};
+    benchRun(reschedule, [&](uint64_t) {
+        Wheel::Entry &timer = timers[timerRandom(seed) % TIMER_POOL];
+        if (timer.scheduled())
+            wheel.schedule(timer, wheel.now() + timerDelay(seed));
+    });
+    benchSink(sink + wheel.size());
+}
+
+struct HeapTimer
+{
+    uint64_t expires;
+    uint32_t id;
+    uint32_t generation;
+
+    bool operator>(const HeapTimer &other) const { return expires > other.expires; }
+};
+
+static void benchHeap(void)
+{
+    typedef std::priority_queue<HeapTimer, std::vector<HeapTimer>, std::greater<HeapTimer> > Heap;
+    std::vector<uint32_t> generation(TIMER_POOL, 0);
+    std::vector<bool> scheduled(TIMER_POOL, false);
+    std::vector<uint32_t> idle;
+    std::vector<HeapTimer> storage;
+    uint32_t seed = 2463534242u;
+    uint64_t sink = 0;
+    uint64_t now = 0;
+
+    storage.reserve(4 * TIMER_POOL);
+    Heap heap(std::greater<HeapTimer>(), std::move(storage));
+    idle.reserve(TIMER_POOL);
+    for (uint32_t k = TIMER_POOL; k-- > 0;)
+        idle.push_back(k);
+
+    auto schedule = [&](uint32_t id, uint64_t expires) {
+        HeapTimer timer = {expires, id, ++generation[id]};
+        scheduled[id] = true;
+        heap.push(timer);
+    };
+    auto advance = [&](uint64_t to) {
+        now = to;
+        while (!heap.empty() && heap.top().expires <= now)
+        {
+            HeapTimer timer = heap.top();
+            heap.pop();
+            if (timer.generation == generation[timer.id])
+            {
+                scheduled[timer.id] = false;
+                idle.push_back(timer.id);
+                sink += timer.expires;
+            }
+        }
+    };
+
+    for (uint32_t k = 0; k < TIMER_COUNT; k++)
+    {
+        schedule(idle.back(), timerDelay(seed));
+        idle.pop_back();
+    }
+
+    BenchCase scheduleFire = {"heap", "schedule_fire", sizeof(HeapTimer), TIMER_COUNT, 1};
+    benchRun(scheduleFire, [&](uint64_t i) {
+        if (!idle.empty())
+        {
+            schedule(idle.back(), now + timerDelay(seed));
+            idle.pop_back();
+        }
+        if (i % TIMER_OPS_PER_TICK == 0)
+            advance(now + 1);
+    });
+
+    BenchCase reschedule = {"heap", "reschedule", sizeof(HeapTimer), TIMER_COUNT, 1};
+    benchRun(reschedule, [&](uint64_t) {
+        uint32_t id = timerRandom(seed) % TIMER_POOL;
+        if (scheduled[id])
+            schedule(id, now + timerDelay(seed));
+    });
+    benchSink(sink + heap.size());
+}
+
+BENCH_SUITE(timing_wheel)
+{
+    benchWheel();
+    benchHeap();
+}
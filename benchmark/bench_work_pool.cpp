@@ -0,0 +1,93 @@
+/*
+ * FiFoWorkPool benchmarks: scaling from 1 to 32 threads against one FiFo
+ * shared behind a mutex. In the balanced case every thread writes and reads
+ * one element per operation, in the skewed case only the even threads
+ * write (two elements) and the odd threads live from stealing.
+ */
+#include <mutex>
+#include <vector>
+#include "Bench.h"
+#include "FiFo.h"
+#include "FiFoWorkPool.h"
+
+static const uint16_t WORK_POOL_WORKERS = 32;
+static const uint32_t WORK_POOL_THREADS[] = {1, 2, 4, 8, 16, 32};
+static const uint16_t WORK_POOL_DEPTH = 1024;
+static const uint16_t WORK_POOL_SHARED_DEPTH = 16383;
+
+// Per thread sum of the read elements, on its own cache line
+struct WorkPoolSink
+{
+    alignas(FIFO_CACHE_LINE_SIZE) uint64_t value;
+};
+
+BENCH_SUITE(work_pool)
+{
+    typedef FiFoWorkPool<uint32_t, WORK_POOL_WORKERS> Pool;
+    std::vector<uint32_t> storage(WORK_POOL_WORKERS * WORK_POOL_DEPTH);
+    std::vector<uint32_t> shared(WORK_POOL_SHARED_DEPTH);
+    Pool pool;
+    FiFo<uint32_t> fifo;
+    std::mutex lock;
+    WorkPoolSink sinks[WORK_POOL_WORKERS] = {};
+
+    for (uint8_t v = 0; v < sizeof(WORK_POOL_THREADS) / sizeof(WORK_POOL_THREADS[0]); v++)
+    {
+        uint32_t threads = WORK_POOL_THREADS[v];
+
+        for (uint16_t w = 0; w < WORK_POOL_WORKERS; w++)
+            pool.initWorker(w, (uint8_t *)&storage[w * WORK_POOL_DEPTH], WORK_POOL_DEPTH * sizeof(uint32_t));
+        BenchCase balanced = {"FiFoWorkPool", "write_read", sizeof(uint32_t), WORK_POOL_DEPTH, threads};
+        benchRunThreads(balanced, [&](uint32_t t, uint64_t i) {
+            uint32_t value = (uint32_t)i;
+            pool.write((uint16_t)t, value);
+            if (pool.read((uint16_t)t, value))
+                sinks[t].value += value;
+        });
+
+        for (uint16_t w = 0; w < WORK_POOL_WORKERS; w++)
+            pool.initWorker(w, (uint8_t *)&storage[w * WORK_POOL_DEPTH], WORK_POOL_DEPTH * sizeof(uint32_t));
+        BenchCase skewed = {"FiFoWorkPool", "skewed_steal", sizeof(uint32_t), WORK_POOL_DEPTH, threads};
+        benchRunThreads(skewed, [&](uint32_t t, uint64_t i) {
+            uint32_t value = (uint32_t)i;
+            if (t % 2 == 0)
+            {
+                pool.write((uint16_t)t, value);
+                pool.write((uint16_t)t, value);
+            }
+            if (pool.read((uint16_t)t, value))
+                sinks[t].value += value;
+        });
+
+        fifo.initBuffer((uint8_t *)&shared[0], WORK_POOL_SHARED_DEPTH * sizeof(uint32_t));
+        BenchCase lockedBalanced = {"FiFo+mutex", "write_read", sizeof(uint32_t), WORK_POOL_SHARED_DEPTH, threads};
+        benchRunThreads(lockedBalanced, [&](uint32_t t, uint64_t i) {
+            uint32_t value = (uint32_t)i;
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                if (fifo.getFreeBufferSpace() >= sizeof(value))
+                    fifo.write(&value);
+            }
+            std::lock_guard<std::mutex> guard(lock);
+            if (fifo.dataAvailable())
+                sinks[t].value += fifo.read();
+        });
+
+        fifo.initBuffer((uint8_t *)&shared[0], WORK_POOL_SHARED_DEPTH * sizeof(uint32_t));
+        BenchCase lockedSkewed = {"FiFo+mutex", "skewed_steal", sizeof(uint32_t), WORK_POOL_SHARED_DEPTH, threads};
+        benchRunThreads(lockedSkewed, [&](uint32_t t, uint64_t i) {
+            uint32_t value = (uint32_t)i;
+            if (t % 2 == 0)
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                for (uint8_t n = 0; n < 2 && fifo.getFreeBufferSpace() >= sizeof(value); n++)
+                    fifo.write(&value);
+            }
+            std::lock_guard<std::mutex> guard(lock);
+            if (fifo.dataAvailable())
+                sinks[t].value += fifo.read();
+        });
+    }
+    for (uint16_t w = 0; w < WORK_POOL_WORKERS; w++)
+        benchSink(sinks[w].value);
+}
@@ -0,0 +1,183 @@
+#ifndef BUFFER_STATS_H
+#define BUFFER_STATS_H
+
+#include <atomic>
+#include <stdint.h>
+
+/**
+ * @brief Number of bins of the occupancy histogram.
+ */
+#ifndef BUFFER_STATS_HISTOGRAM_BINS
+#define BUFFER_STATS_HISTOGRAM_BINS 8
+#endif
+
+/**
+ * @brief Statistics Snapshot
+ *
+ * Copy of the runtime statistics of a buffer. Sizes are given in the unit
+ * of the buffer (bytes for FiFo, entries for RingBuffer). pushed and popped
+ * count elements. Bin i of the occupancy histogram counts the write calls
+ * after which the buffer was filled to [i, i + 1) / BUFFER_STATS_HISTOGRAM_BINS
+ * of its capacity, the last bin includes the completely filled buffer.
+ */
+typedef struct
+{
+   uint32_t pushed;
+   uint32_t popped;
+   uint32_t rejected;
+   uint32_t overwritten;
+   uint32_t wraps;
+   uint16_t highWater;
+   uint16_t capacity;
+   uint32_t occupancy[BUFFER_STATS_HISTOGRAM_BINS];
+} BufferStatistics_t;
+
+/**
+ * @brief The BufferNoStats class
+ *
+ * Default statistics policy of the buffers. All hooks are empty, so the
+ * compiler removes them together with their arguments.
+ */
+class BufferNoStats
+{
+public:
+    void pushed(uint16_t count, uint16_t used, uint16_t capacity) { (void)count; (void)used; (void)capacity; }
+    void popped(uint16_t count) { (void)count; }
+    void rejected(void) {}
+    void overwritten(void) {}
+    void wrapped(void) {}
+
+    /**
+     * @brief Buffers skip their own bookkeeping for the statistics.
+     */
+    static const bool enabled = false;
+
+    void snapshot(BufferStatistics_t &stats) const
+    {
+        stats = BufferStatistics_t();
+    }
+
+    void reset(void) {}
+};
+
+/**
+ * @brief The BufferStats class
+ *
+ * Statistics policy which records the traffic of a buffer. Every counter
+ * is written by one side only (the producer, except popped which is
+ * written by the consumer), so the hooks use plain relaxed loads and stores
+ * instead of read-modify-write operations. snapshot() can be called from
+ * any thread while the buffer is in use; the fields are read one by one,
+ * so they may belong to slightly different points in time.
+ */
+class BufferStats
+{
+public:
+    BufferStats() { reset(); }
+
+    /**
+     * @brief Record a write.
+     * @param count number of written elements
+     * @param used fill level after the write
+     * @param capacity capacity of the buffer
+     */
+    void pushed(uint16_t count, uint16_t used, uint16_t capacity)
+    {
+        m_pushed.store(m_pushed.load(std::memory_order_relaxed) + count, std::memory_order_relaxed);
+        if (used > m_high_water.load(std::memory_order_relaxed))
+        {
+            m_high_water.store(used, std::memory_order_relaxed);
+        }
+        if (capacity > 0)
+        {
+            uint32_t bin = (uint32_t)used * BUFFER_STATS_HISTOGRAM_BINS / capacity;
+            if (bin >= BUFFER_STATS_HISTOGRAM_BINS)
+            {
+                bin = BUFFER_STATS_HISTOGRAM_BINS - 1;
+            }
+            increment(m_occupancy[bin]);
+        }
+    }
+
+    /**
+     * @brief Record a read.
+     * @param count number of read elements
+     */
+    void popped(uint16_t count)
+    {
+        m_popped.store(m_popped.load(std::memory_order_relaxed) + count, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Record a write which was refused by the buffer.
+     */
+    void rejected(void) { increment(m_rejected); }
+
+    /**
+     * @brief Record a write which replaced unread data.
+     */
+    void overwritten(void) { increment(m_overwritten); }
+
+    /**
+     * @brief Record a wrap around of the buffer index.
+     */
+    void wrapped(void) { increment(m_wraps); }
+
+    /**
+     * @brief Buffers keep the bookkeeping the hooks need, e.g. slot occupancy.
+     */
+    static const bool enabled = true;
+
+    /**
+     * @brief Copy the current statistics.
+     * @param stats destination of the copy, capacity is left untouched
+     */
+    void snapshot(BufferStatistics_t &stats) const
+    {
+        stats.pushed = m_pushed.load(std::memory_order_relaxed);
+        stats.popped = m_popped.load(std::memory_order_relaxed);
+        stats.rejected = m_rejected.load(std::memory_order_relaxed);
+        stats.overwritten = m_overwritten.load(std::memory_order_relaxed);
+        stats.wraps = m_wraps.load(std::memory_order_relaxed);
+        stats.highWater = m_high_water.load(std::memory_order_relaxed);
+        for (uint8_t i = 0; i < BUFFER_STATS_HISTOGRAM_BINS; i++)
+        {
+            stats.occupancy[i] = m_occupancy[i].load(std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * @brief Clear all counters.
+     *
+     * Must not run concurrently with the producer or consumer.
+     */
+    void reset(void)
+    {
+        m_pushed.store(0, std::memory_order_relaxed);
+        m_popped.store(0, std::memory_order_relaxed);
+        m_rejected.store(0, std::memory_order_relaxed);
+        m_overwritten.store(0, std::memory_order_relaxed);
+        m_wraps.store(0, std::memory_order_relaxed);
+        m_high_water.store(0, std::memory_order_relaxed);
+        for (uint8_t i = 0; i < BUFFER_STATS_HISTOGRAM_BINS; i++)
+        {
+            m_occupancy[i].store(0, std::memory_order_relaxed);
+        }
+    }
+
+private:
+    static void increment(std::atomic<uint32_t> &counter)
+    {
+        counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    std::atomic<uint32_t> m_pushed;
+    std::atomic<uint32_t> m_popped;
+    std::atomic<uint32_t> m_rejected;
+    std::atomic<uint32_t> m_overwritten;
+    std::atomic<uint32_t> m_wraps;
+    std::atomic<uint16_t> m_high_water;
+    std::atomic<uint32_t> m_occupancy[BUFFER_STATS_HISTOGRAM_BINS];
+};
+
+#endif
@@ -0,0 +1,297 @@
+#ifndef COMPRESSED_RING_BUFFER_H
+#define COMPRESSED_RING_BUFFER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @class CompressedRingBuffer
+ * @brief History ring of int32_t samples stored as zig-zag varint deltas.
+ *
+ * Samples are packed into fixed-size blocks. A block keeps its first sample
+ * as base value in the block index, every further sample is stored as the
+ * zig-zag encoded difference to its predecessor in 1 to 5 bytes, so slowly
+ * varying values cost one byte instead of four. When all blocks are in use
+ * the oldest block is dropped as a whole to make room.
+ *
+ * Offsets follow RingBuffer::at(): at(-1) is the newest sample, at(-2) the
+ * one before. atIndex(0) is the oldest stored sample. Random access finds
+ * the block with a binary search over the block index and decodes from the
+ * block start; decode() streams a range into an array and is the fast way
+ * to read many samples.
+ *
+ * @tparam BlockBytes Size of the encoded data of one block in bytes.
+ */
+template <uint16_t BlockBytes = 64>
+class CompressedRingBuffer
+{
+public:
+    /**
+     * @brief Construct a new Compressed Ring Buffer object.
+     *
+     * @param blocks Number of blocks, the buffer needs
+     * blocks * (BlockBytes + 12) bytes.
+     */
+    explicit CompressedRingBuffer(uint16_t blocks) : m_blocks(blocks > 0 ? blocks : 1)
+    {
+        m_index = new Block[m_blocks];
+        m_data = new uint8_t[(uint32_t)m_blocks * BlockBytes];
+        clear();
+    }
+
+    /**
+     * @brief Destroy the Compressed Ring Buffer object and release the storage.
+     */
+    ~CompressedRingBuffer()
+    {
+        delete[] m_index;
+        delete[] m_data;
+    }
+
+    CompressedRingBuffer(const CompressedRingBuffer &) = delete;
+    CompressedRingBuffer &operator=(const CompressedRingBuffer &) = delete;
+
+    /**
+     * @brief Remove all samples.
+     */
+    void clear(void)
+    {
+        m_head = 0;
+        m_used = 0;
+        m_length = 0;
+        m_sequence = 0;
+        m_last = 0;
+    }
+
+    /**
+     * @brief Append a sample, dropping the oldest block if the buffer is full.
+     *
+     * @param value The sample.
+     */
+    void add(int32_t value)
+    {
+        uint8_t encoded[5];
+        uint8_t bytes = encode((uint32_t)value - (uint32_t)m_last, encoded);
+        Block *block = m_used > 0 ? &m_index[newestBlock()] : NULL;
+
+        if (block == NULL || block->count == 0xFFFF || block->bytes + bytes > BlockBytes)
+        {
+            if (m_used == m_blocks)
+            {
+                m_length -= m_index[m_head].count;
+                m_head = m_head + 1 < m_blocks ? m_head + 1 : 0;
+                m_used--;
+            }
+            m_used++;
+            block = &m_index[newestBlock()];
+            block->base = value;
+            block->first = m_sequence;
+            block->count = 1;
+            block->bytes = 0;
+        }
+        else
+        {
+            uint8_t *p = blockData(newestBlock()) + block->bytes;
+            for (uint8_t i = 0; i < bytes; i++)
+            {
+                p[i] = encoded[i];
+            }
+            block->bytes += bytes;
+            block->count++;
+        }
+        m_last = value;
+        m_length++;
+        m_sequence++;
+    }
+
+    /**
+     * @brief Get the sample at an offset from the end.
+     *
+     * @param offset Negative offset, -1 is the newest sample.
+     * @return int32_t The sample, 0 if the offset is out of range.
+     */
+    int32_t at(int32_t offset)
+    {
+        int32_t value = 0;
+        if (offset < 0 && (uint32_t)(-(int64_t)offset) <= m_length)
+            value = atIndex(m_length - (uint32_t)(-(int64_t)offset));
+        return value;
+    }
+
+    /**
+     * @brief Get the sample at a position from the start.
+     *
+     * @param idx Position, 0 is the oldest sample.
+     * @return int32_t The sample, 0 if idx is out of range.
+     */
+    int32_t atIndex(uint32_t idx)
+    {
+        int32_t value = 0;
+        decode(idx, &value, 1);
+        return value;
+    }
+
+    /**
+     * @brief Get the newest sample.
+     *
+     * @return int32_t The sample, 0 if the buffer is empty.
+     */
+    int32_t current(void) { return m_last; }
+
+    /**
+     * @brief Decode consecutive samples into an array.
+     *
+     * @param idx Position of the first sample, 0 is the oldest sample.
+     * @param out Destination with space for n samples.
+     * @param n Number of samples to decode.
+     * @return uint32_t Number of decoded samples.
+     */
+    uint32_t decode(uint32_t idx, int32_t *out, uint32_t n)
+    {
+        uint32_t done = 0;
+        uint16_t k;
+        uint32_t skip;
+
+        if (idx < m_length)
+        {
+            if (n > m_length - idx)
+                n = m_length - idx;
+
+            findBlock(idx, k, skip);
+            while (done < n)
+            {
+                uint16_t block = ringBlock(k);
+                const uint8_t *p = blockData(block);
+                uint32_t value = (uint32_t)m_index[block].base;
+                uint16_t count = m_index[block].count;
+
+                for (uint32_t i = 0; i < skip; i++)
+                {
+                    value += decodeNext(p);
+                }
+                out[done++] = (int32_t)value;
+                for (uint32_t i = skip + 1; i < count && done < n; i++)
+                {
+                    value += decodeNext(p);
+                    out[done++] = (int32_t)value;
+                }
+                skip = 0;
+                k++;
+            }
+        }
+        return done;
+    }
+
+    /**
+     * @brief Get the number of stored samples.
+     *
+     * @return uint32_t The number of samples.
+     */
+    uint32_t length(void) { return m_length; }
+
+    /**
+     * @brief Get the number of blocks.
+     *
+     * @return uint16_t The number of blocks.
+     */
+    uint16_t blocks(void) { return m_blocks; }
+
+    /**
+     * @brief Get the number of blocks holding samples.
+     *
+     * @return uint16_t The number of used blocks.
+     */
+    uint16_t usedBlocks(void) { return m_used; }
+
+    /**
+     * @brief Get the memory used for data and block index.
+     *
+     * @return uint32_t Size in bytes.
+     */
+    uint32_t memorySize(void) { return (uint32_t)m_blocks * (BlockBytes + sizeof(Block)); }
+
+private:
+    struct Block
+    {
+        int32_t base;   ///< First sample of the block.
+        uint32_t first; ///< Sequence number of the first sample.
+        uint16_t count; ///< Number of samples including the base.
+        uint16_t bytes; ///< Number of encoded bytes.
+    };
+
+    uint8_t *blockData(uint16_t block) { return &m_data[(uint32_t)block * BlockBytes]; }
+
+    uint16_t ringBlock(uint16_t k) { return (uint16_t)(((uint32_t)m_head + k) % m_blocks); }
+
+    uint16_t newestBlock(void) { return ringBlock(m_used - 1); }
+
+    /**
+     * @brief Find the block holding a sample by binary search over the block index.
+     *
+     * @param idx Position of the sample.
+     * @param k Receives the block number counted from the oldest block.
+     * @param skip Receives the position of the sample in the block.
+     */
+    void findBlock(uint32_t idx, uint16_t &k, uint32_t &skip)
+    {
+        uint32_t oldest = m_index[m_head].first;
+        uint16_t lo = 0;
+        uint16_t hi = m_used - 1;
+
+        while (lo < hi)
+        {
+            uint16_t mid = lo + (hi - lo + 1) / 2;
+            if (m_index[ringBlock(mid)].first - oldest <= idx)
+                lo = mid;
+            else
+                hi = mid - 1;
+        }
+        k = lo;
+        skip = idx - (m_index[ringBlock(lo)].first - oldest);
+    }
+
+    static uint8_t encode(uint32_t delta, uint8_t *out)
+    {
+        uint32_t z = (delta << 1) ^ (uint32_t)((int32_t)delta >> 31);
+        uint8_t bytes = 0;
+
+        while (z >= 0x80)
+        {
+            out[bytes++] = (uint8_t)(z | 0x80);
+            z >>= 7;
+        }
+        out[bytes++] = (uint8_t)z;
+        return bytes;
+    }
+
+    static uint32_t decodeNext(const uint8_t *&p)
+    {
+        uint32_t z = *p++;
+
+        if (z >= 0x80)
+        {
+            uint8_t shift = 7;
+            uint32_t b;
+            z &= 0x7F;
+            do
+            {
+                b = *p++;
+                z |= (b & 0x7F) << shift;
+                shift += 7;
+            } while (b >= 0x80);
+        }
+        return (z >> 1) ^ (0u - (z & 1));
+    }
+
+private:
+    Block *m_index;     ///< Block index, one entry per block.
+    uint8_t *m_data;    ///< Encoded deltas, BlockBytes per block.
+    uint16_t m_blocks;  ///< Number of blocks.
+    uint16_t m_head;    ///< Oldest used block.
+    uint16_t m_used;    ///< Number of used blocks.
+    uint32_t m_length;  ///< Number of stored samples.
+    uint32_t m_sequence; ///< Sequence number of the next sample.
+    int32_t m_last;     ///< Newest sample, base of the next delta.
+};
+
+#endif
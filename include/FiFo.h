@@ -9,7 +9,18 @@
 #ifndef FIFO_H_
 #define FIFO_H_
 
+#include "stddef.h"
 #include "stdint.h"
+#include "string.h"
+#include "BufferStats.h"
+#include "FiFoTrace.h"
+#include "FiFoWatermark.h"
+
+#if defined(__linux__)
+#include "errno.h"
+#include "sys/types.h"
+#include "sys/uio.h"
+#endif
 
 
 #define FIFO_N_OK                        0
@@ -152,7 +163,18 @@ typedef struct
 
 
 
-template<typename FiFoType> class FiFo
+/**
+ * @brief FiFo Buffer
+ *
+ * @tparam FiFoType type of the elements
+ * @tparam FiFoStats statistics policy, BufferNoStats (default) or BufferStats.
+ * @tparam FiFoTrace latency trace policy, FiFoNoTrace (default) or FiFoLatencyTrace.
+ * @tparam FiFoWatermark watermark policy, FiFoNoWatermark (default) or FiFoWatermarks.
+ * With the default policies the hooks compile to nothing.
+ */
+template<typename FiFoType, class FiFoStats = BufferNoStats, class FiFoTrace = FiFoNoTrace,
+         class FiFoWatermark = FiFoNoWatermark>
+class FiFo : private FiFoStats, private FiFoTrace, private FiFoWatermark
 {
 
    public:
@@ -176,6 +198,31 @@ template<typename FiFoType> class FiFo
        */
       void updateBufferStatus(void);
 
+      /**
+       * @brief Record a write in the statistics, the latency trace and the watermarks
+       */
+      void recordWrite(uint16_t count);
+
+      /**
+       * @brief Check Both Watermarks Again After One Was Reported
+       */
+      void settleWatermarks(void);
+
+      /**
+       * @brief Advance FIFO Read Counter By Several Bytes
+       */
+      void advanceReadCounter(uint16_t bytes);
+
+      /**
+       * @brief Advance FIFO Write Counter By Several Bytes
+       */
+      void advanceWriteCounter(uint16_t bytes);
+
+      /**
+       * @brief Can Elements Be Accessed In Place Starting At Index
+       */
+      bool isElementAligned(uint16_t index);
+
    public:
       /**
        * @brief FIFO Constructor
@@ -224,6 +271,80 @@ template<typename FiFoType> class FiFo
        */
       FiFoType read(void);
 
+      /**
+       *  @brief Drain Elements From FIFO
+       *
+       *  @param [in] max_n Maximum number of elements to read
+       *  @param [in] visitor Callable taking (const FiFoType* elements, uint16_t count)
+       *  @return Number of read elements
+       *
+       *  @details The readable range is determined once. The visitor gets the
+       *  elements in place, in up to two contiguous chunks, when the buffer is
+       *  aligned for FiFoType and its size is a multiple of the element size;
+       *  otherwise every element is copied and passed as chunk of one. The read
+       *  counter and the buffer status are updated once at the end.
+       */
+      template<class Visitor>
+      uint16_t drain(uint16_t max_n, Visitor visitor);
+
+      /**
+       *  @brief Drain Elements From FIFO Into Array
+       *
+       *  @param [out] out Destination with space for max_n elements
+       *  @param [in] max_n Maximum number of elements to read
+       *  @return Number of read elements
+       */
+      uint16_t drain_into(FiFoType* out, uint16_t max_n);
+
+      /**
+       *  @brief Fill FIFO From Generator
+       *
+       *  @param [in] max_n Maximum number of elements to write
+       *  @param [in] generator Callable taking (FiFoType* slots, uint16_t count)
+       *  and returning the number of slots it filled
+       *  @return Number of written elements
+       *
+       *  @details Counterpart of drain(): the free range is determined once, the
+       *  generator writes the elements in place where possible and the write
+       *  counter is updated once. Stops early when the generator fills fewer
+       *  slots than offered.
+       */
+      template<class Generator>
+      uint16_t fill(uint16_t max_n, Generator generator);
+
+#if defined(__linux__)
+      /**
+       *  @brief Write FIFO Data To File Descriptor
+       *
+       *  @param [in] fd File descriptor, e.g. a socket, pipe or file
+       *  @param [in] max Maximum number of bytes to write
+       *  @return Number of written bytes, 0 if the FIFO is empty,
+       *  -1 on error with errno set (EAGAIN for a non-blocking fd)
+       *
+       *  @details The queued bytes are passed to the kernel in place with one
+       *  writev() over the up to two contiguous segments of the buffer, the
+       *  read counter is advanced by the bytes the kernel accepted. A partial
+       *  write leaves the rest queued. Only for byte FIFOs.
+       */
+      ssize_t write_to_fd(int fd, uint16_t max);
+
+      /**
+       *  @brief Read From File Descriptor Into FIFO
+       *
+       *  @param [in] fd File descriptor, e.g. a socket, pipe or file
+       *  @param [in] max Maximum number of bytes to read
+       *  @return Number of read bytes, 0 only at end of file, -1 on error with
+       *  errno set: EAGAIN for a non-blocking fd without data, ENOBUFS if
+       *  nothing was read because the FIFO is full or not initialised or
+       *  max is 0
+       *
+       *  @details Counterpart of write_to_fd(): one readv() straight into the
+       *  free segments of the buffer. Only for byte FIFOs. The fd is not
+       *  touched on ENOBUFS, so a full FIFO never looks like a closed peer.
+       */
+      ssize_t read_from_fd(int fd, uint16_t max);
+#endif
+
       /**
        *  @brief Get FIFO Buffer Status
        *
@@ -254,6 +375,61 @@ template<typename FiFoType> class FiFo
 
       uint16_t getSizeOfBuffer(void);
 
+      /**
+       *  @brief Get FIFO Statistics
+       *
+       *  @return Snapshot of the statistics, all zero without a statistics policy
+       *
+       *  @details Can be called while producer and consumer are running.
+       */
+      BufferStatistics_t getStatistics(void);
+
+      /**
+       *  @brief Reset FIFO Statistics
+       */
+      void resetStatistics(void);
+
+      /**
+       *  @brief Init FIFO Latency Trace
+       *
+       *  @param [in] stamps Timestamp storage, one entry per element the FIFO can hold
+       *  @param [in] count Number of entries in stamps
+       *
+       *  @details Only used with the FiFoLatencyTrace policy.
+       */
+      void initTrace(BufferTimestamp_t* stamps, uint16_t count);
+
+      /**
+       *  @brief Set FIFO Trace Name
+       *
+       *  @param [in] name Name reported by FiFoLatencyTrace::exportAll()
+       */
+      void setTraceName(const char* name);
+
+      /**
+       *  @brief Get FIFO Queueing Latency
+       *
+       *  @return Summary of the queueing delays, all zero without a trace policy
+       */
+      FIFO_Latency_t getLatency(void);
+
+      /**
+       *  @brief Set FIFO Watermarks
+       *
+       *  @param [in] high Used bytes at which callback gets FIFO_WATERMARK_HIGH
+       *  @param [in] low Used bytes at which callback gets FIFO_WATERMARK_LOW, below high
+       *  @param [in] callback Called once per crossing, NULL disables the watermarks
+       *  @param [in] context Passed to callback
+       *
+       *  @details Only used with the FiFoWatermarks policy. The high mark is
+       *  reported from the writing context once the used size reaches high,
+       *  the low mark from the reading context once it falls to low again.
+       *  A mark the other side crossed while a callback ran is reported right
+       *  after it, from the same context. initBuffer() reports a pending low
+       *  mark, setWatermarks() drops it.
+       */
+      void setWatermarks(uint16_t high, uint16_t low, FIFO_WatermarkCallback_t callback, void* context);
+
    private:
       FIFO_Buffer_t m_buffer;
 };
@@ -261,7 +437,7 @@ template<typename FiFoType> class FiFo
 /**************************************************************************************************
  * FUNCTION: FiFo(...)
  *************************************************************************************************/
-template<typename FiFoType> inline FiFo<FiFoType>::FiFo()
+template<typename FiFoType, class FiFoStats, class FiFoTrace, class FiFoWatermark> inline FiFo<FiFoType, FiFoStats, FiFoTrace, FiFoWatermark>::FiFo()
 {
    m_buffer.bufferPtr = NULL;
    m_buffer.bufferSize = 0;
@@ -275,7 +451,7 @@ template<typename FiFoType> inline FiFo<FiFoType>::FiFo()
 /**************************************************************************************************
  * FUNCTION: void FIOF_InitBuffer(...)
  *************************************************************************************************/
-template<typename FiFoType> inline void FiFo<FiFoType>::initBuffer(uint8_t *avBuffer,
+template<typename FiFoType, class FiFoStats, class FiFoTrace, class FiFoWatermark> inline void FiFo<FiFoType, FiFoStats, FiFoTrace, FiFoWatermark>::initBuffer(uint8_t *avBuffer,
          uint16_t avSize)
 {
    if (avBuffer != NULL)
@@ -286,6 +462,8 @@ template<typename FiFoType> inline void FiFo<FiFoType>::initBuffer(uint8_t *avBu
       m_buffer.counter.overflow = false;
       m_buffer.counter.read = 0u;
       m_buffer.counter.write = 0u;
+      FiFoTrace::restartTrace();
+      FiFoWatermark::restartWatermarks();
    }
    else
    {
@@ -297,10 +475,10 @@ template<typename FiFoType> inline void FiFo<FiFoType>::initBuffer(uint8_t *avBu
 /**************************************************************************************************
  * FUNCTION: void FIFO_Write(...)
  *************************************************************************************************/
-template<typename FiFoType> inline bool FiFo<FiFoType>::write(FiFoType* p)
+template<typename FiFoType, class FiFoStats, class FiFoTrace, class FiFoWatermark> inline bool FiFo<FiFoType, FiFoStats, FiFoTrace, FiFoWatermark>::write(FiFoType* p)
 {
    uint16_t i;
-   uint8_t count;
+   uint16_t count;
    bool status = false;
    uint8_t* data;
 
@@ -314,9 +492,14 @@ template<typename FiFoType> inline bool FiFo<FiFoType>::write(FiFoType* p)
          incrementWriteCounter();
          updateBufferStatus();
       }
+      recordWrite(1);
 
       status = true;
    }
+   else
+   {
+      FiFoStats::rejected();
+   }
    return status;
 }
 
@@ -324,10 +507,10 @@ template<typename FiFoType> inline bool FiFo<FiFoType>::write(FiFoType* p)
 /**************************************************************************************************
  * FUNCTION: void FIFO_Write(...)
  *************************************************************************************************/
-template<typename FiFoType> inline bool FiFo<FiFoType>::write(FiFoType* p, uint16_t length, uint16_t typeSize)
+template<typename FiFoType, class FiFoStats, class FiFoTrace, class FiFoWatermark> inline bool FiFo<FiFoType, FiFoStats, FiFoTrace, FiFoWatermark>::write(FiFoType* p, uint16_t length, uint16_t typeSize)
 {
    uint16_t i;
-   uint8_t count;
+   uint16_t count;
    bool status = false;
    uint8_t* data;
 
@@ -335,19 +518,21 @@ template<typename FiFoType> inline bool FiFo<FiFoType>::write(FiFoType* p, uint1
    {
 	  data = (uint8_t*) p;
 
-	  Serial.print("DataLen = "); Serial.println(typeSize * length);
-	  Serial.print("Data = ");
 	  for (count = 0; count < (typeSize * length); count++)
 	  {
-		 Serial.print((char)data[count]);
 		 i = FIFO_GET_WRITE_COUNT(m_buffer);
 		 FIFO_WRITE(m_buffer, i, data[count]);
 		 incrementWriteCounter();
 		 updateBufferStatus();
 	  }
+	  recordWrite((uint16_t) ((typeSize * length) / sizeof(FiFoType)));
 
 	  status = true;
    }
+   else
+   {
+      FiFoStats::rejected();
+   }
    return status;
 }
 
@@ -355,12 +540,12 @@ template<typename FiFoType> inline bool FiFo<FiFoType>::write(FiFoType* p, uint1
 /**************************************************************************************************
  * FUNCTION: char FIFO_Read(...)
  *************************************************************************************************/
-template<typename FiFoType> inline FiFoType FiFo<FiFoType>::read(void)
+template<typename FiFoType, class FiFoStats, class FiFoTrace, class FiFoWatermark> inline FiFoType FiFo<FiFoType, FiFoStats, FiFoTrace, FiFoWatermark>::read(void)
 {
    uint8_t p[sizeof(FiFoType)] = {0};
    FiFoType* ret = NULL;
    uint16_t i;
-   uint8_t count;
+   uint16_t count;
    if (FIFO_IS_BUFFER_READY(m_buffer) == true &&
    FIFO_IS_BUFFER_EMPTY(m_buffer) == false)
    {
@@ -371,24 +556,368 @@ template<typename FiFoType> inline FiFoType FiFo<FiFoType>::read(void)
          incrementReadCounter();
          updateBufferStatus();
       }
+      FiFoStats::popped(1);
+      FiFoTrace::dequeued();
+      if (FiFoWatermark::drained(getUsedBufferSize()) == true)
+      {
+         settleWatermarks();
+      }
    }
 
    ret = (FiFoType*) p;
    return *ret;
 }
 
+/**************************************************************************************************
+ * FUNCTION: uint16_t FIFO_Drain(...)
+ *************************************************************************************************/
+template<typename FiFoType, class FiFoStats, class FiFoTrace, class FiFoWatermark>
+template<class Visitor>
+inline uint16_t FiFo<FiFoType, FiFoStats, FiFoTrace, FiFoWatermark>::drain(uint16_t max_n, Visitor visitor)
+{
+   uint16_t n = 0;
+   uint16_t done = 0;
+   uint16_t r;
+   uint16_t count;
+
+   if (FIFO_IS_BUFFER_READY(m_buffer) == true &&
+   FIFO_IS_BUFFER_EMPTY(m_buffer) == false)
+   {
+      n = getUsedBufferSize() / sizeof(FiFoType);
+      if (n > max_n)
+      {
+         n = max_n;
+      }
+
+      r = FIFO_GET_READ_COUNT(m_buffer);
+      if (isElementAligned(r) == true)
+      {
+         while (done < n)
+         {
+            count = (FIFO_GET_BUFFER_SIZE(m_buffer) - r) / sizeof(FiFoType);
+            if (count > n - done)
+            {
+               count = n - done;
+            }
+            visitor((const FiFoType*) &FIFO_READ(m_buffer, r), count);
+            done += count;
+            r += count * sizeof(FiFoType);
+            if (r >= FIFO_GET_BUFFER_SIZE(m_buffer))
+            {
+               r = 0;
+            }
+         }
+      }
+      else
+      {
+         FiFoType element;
+         uint8_t* data = (uint8_t*) &element;
+         for (done = 0; done < n; done++)
+         {
+            for (count = 0; count < sizeof(FiFoType); count++)
+            {
+               data[count] = FIFO_READ(m_buffer, r);
+               r = (r + 1 < FIFO_GET_BUFFER_SIZE(m_buffer)) ? r + 1 : 0;
+            }
+            visitor((const FiFoType*) &element, 1);
+         }
+      }
+
+      advanceReadCounter(n * sizeof(FiFoType));
+   }
+   return n;
+}
+
+/**************************************************************************************************
+ * FUNCTION: uint16_t FIFO_DrainInto(...)
+ *************************************************************************************************/
+template<typename FiFoType, class FiFoStats, class FiFoTrace, class FiFoWatermark>
+inline uint16_t FiFo<FiFoType, FiFoStats, FiFoTrace, FiFoWatermark>::drain_into(FiFoType* out, uint16_t max_n)
+{
+   uint16_t n = 0;
+   uint16_t r;
+   uint16_t bytes;
+   uint16_t first;
+   uint8_t* dst = (uint8_t*) out;
+
+   if (FIFO_IS_BUFFER_READY(m_buffer) == true &&
+   FIFO_IS_BUFFER_EMPTY(m_buffer) == false)
+   {
+      n = getUsedBufferSize() / sizeof(FiFoType);
+      if (n > max_n)
+      {
+         n = max_n;
+      }
+
+      bytes = n * sizeof(FiFoType);
+      r = FIFO_GET_READ_COUNT(m_buffer);
+      first = FIFO_GET_BUFFER_SIZE(m_buffer) - r;
+      if (first > bytes)
+      {
+         first = bytes;
+      }
+      memcpy(dst, &FIFO_READ(m_buffer, r), first);
+      memcpy(dst + first, &FIFO_READ(m_buffer, 0), bytes - first);
+
+      advanceReadCounter(bytes);
+   }
+   return n;
+}
+
+/**************************************************************************************************
+ * FUNCTION: uint16_t FIFO_Fill(...)
+ *************************************************************************************************/
+template<typename FiFoType, class FiFoStats, class FiFoTrace, class FiFoWatermark>
+template<class Generator>
+inline uint16_t FiFo<FiFoType, FiFoStats, FiFoTrace, FiFoWatermark>::fill(uint16_t max_n, Generator generator)
+{
+   uint16_t n = 0;
+   uint16_t done = 0;
+   uint16_t produced;
+   uint16_t w;
+   uint16_t count;
+
+   if (FIFO_IS_BUFFER_READY(m_buffer) == true &&
+   FIFO_IS_BUFFER_FULL(m_buffer) == false)
+   {
+      n = getFreeBufferSpace() / sizeof(FiFoType);
+      if (n > max_n)
+      {
+         n = max_n;
+      }
+
+      w = FIFO_GET_WRITE_COUNT(m_buffer);
+      if (isElementAligned(w) == true)
+      {
+         while (done < n)
+         {
+            count = (FIFO_GET_BUFFER_SIZE(m_buffer) - w) / sizeof(FiFoType);
+            if (count > n - done)
+            {
+               count = n - done;
+            }
+            produced = generator((FiFoType*) &FIFO_READ(m_buffer, w), count);
+            if (produced > count)
+            {
+               produced = count;
+            }
+            done += produced;
+            w += produced * sizeof(FiFoType);
+            if (w >= FIFO_GET_BUFFER_SIZE(m_buffer))
+            {
+               w = 0;
+            }
+            if (produced < count)
+            {
+               break;
+            }
+         }
+      }
+      else
+      {
+         FiFoType element;
+         uint8_t* data = (uint8_t*) &element;
+         for (done = 0; done < n; done++)
+         {
+            if (generator(&element, 1) == 0)
+            {
+               break;
+            }
+            for (count = 0; count < sizeof(FiFoType); count++)
+            {
+               FIFO_WRITE(m_buffer, w, data[count]);
+               w = (w + 1 < FIFO_GET_BUFFER_SIZE(m_buffer)) ? w + 1 : 0;
+            }
+         }
+      }
+
+      if (done > 0)
+      {
+         advanceWriteCounter(done * sizeof(FiFoType));
+         recordWrite(done);
+      }
+   }
+   return done;
+}
+
+#if defined(__linux__)
+/**************************************************************************************************
+ * FUNCTION: ssize_t FIFO_WriteToFd(...)
+ *************************************************************************************************/
+template<typename FiFoType, class FiFoStats, class FiFoTrace, class FiFoWatermark>
+inline ssize_t FiFo<FiFoType, FiFoStats, FiFoTrace, FiFoWatermark>::write_to_fd(int fd, uint16_t max)
+{
+   static_assert(sizeof(FiFoType) == 1, "write_to_fd() needs a byte FIFO");
+   struct iovec iov[2];
+   uint16_t bytes;
+   uint16_t first;
+   uint16_t r;
+   ssize_t ret = 0;
+
+   if (FIFO_IS_BUFFER_READY(m_buffer) == true &&
+   FIFO_IS_BUFFER_EMPTY(m_buffer) == false)
+   {
+      bytes = getUsedBufferSize();
+      if (bytes > max)
+      {
+         bytes = max;
+      }
+
+      r = FIFO_GET_READ_COUNT(m_buffer);
+      first = FIFO_GET_BUFFER_SIZE(m_buffer) - r;
+      if (first > bytes)
+      {
+         first = bytes;
+      }
+      iov[0].iov_base = &FIFO_READ(m_buffer, r);
+      iov[0].iov_len = first;
+      iov[1].iov_base = &FIFO_READ(m_buffer, 0);
+      iov[1].iov_len = bytes - first;
+
+      if (bytes > 0)
+      {
+         do
+         {
+            ret = writev(fd, iov, (bytes > first) ? 2 : 1);
+         } while (ret < 0 && errno == EINTR);
+
+         if (ret > 0)
+         {
+            advanceReadCounter((uint16_t) ret);
+         }
+      }
+   }
+   return ret;
+}
+
+/**************************************************************************************************
+ * FUNCTION: ssize_t FIFO_ReadFromFd(...)
+ *************************************************************************************************/
+template<typename FiFoType, class FiFoStats, class FiFoTrace, class FiFoWatermark>
+inline ssize_t FiFo<FiFoType, FiFoStats, FiFoTrace, FiFoWatermark>::read_from_fd(int fd, uint16_t max)
+{
+   static_assert(sizeof(FiFoType) == 1, "read_from_fd() needs a byte FIFO");
+   struct iovec iov[2];
+   uint16_t bytes = 0;
+   uint16_t first;
+   uint16_t w;
+   ssize_t ret = -1;
+
+   if (FIFO_IS_BUFFER_READY(m_buffer) == true &&
+   FIFO_IS_BUFFER_FULL(m_buffer) == false)
+   {
+      bytes = getFreeBufferSpace();
+      if (bytes > max)
+      {
+         bytes = max;
+      }
+   }
+
+   if (bytes > 0)
+   {
+      w = FIFO_GET_WRITE_COUNT(m_buffer);
+      first = FIFO_GET_BUFFER_SIZE(m_buffer) - w;
+      if (first > bytes)
+      {
+         first = bytes;
+      }
+      iov[0].iov_base = &FIFO_READ(m_buffer, w);
+      iov[0].iov_len = first;
+      iov[1].iov_base = &FIFO_READ(m_buffer, 0);
+      iov[1].iov_len = bytes - first;
+
+      do
+      {
+         ret = readv(fd, iov, (bytes > first) ? 2 : 1);
+      } while (ret < 0 && errno == EINTR);
+
+      if (ret > 0)
+      {
+         advanceWriteCounter((uint16_t) ret);
+         recordWrite((uint16_t) ret);
+      }
+   }
+   else
+   {
+      /* No space to read into, keep 0 for end of file */
+      errno = ENOBUFS;
+   }
+   return ret;
+}
+#endif
+
+/**************************************************************************************************
+ * FUNCTION: void FIFO_AdvanceReadCounter(...)
+ *************************************************************************************************/
+template<typename FiFoType, class FiFoStats, class FiFoTrace, class FiFoWatermark> inline void FiFo<FiFoType, FiFoStats, FiFoTrace, FiFoWatermark>::advanceReadCounter(uint16_t bytes)
+{
+   uint32_t r;
+   uint16_t count;
+
+   r = (uint32_t) FIFO_GET_READ_COUNT(m_buffer) + bytes;
+   if (r >= FIFO_GET_BUFFER_SIZE(m_buffer))
+   {
+      r -= FIFO_GET_BUFFER_SIZE(m_buffer);
+      FIFO_SET_OVERFLOW_STATUS(m_buffer, false);
+   }
+   FIFO_SET_READ_BUFFER(m_buffer, (uint16_t) r);
+   updateBufferStatus();
+
+   count = bytes / sizeof(FiFoType);
+   FiFoStats::popped(count);
+   while (count-- > 0)
+   {
+      FiFoTrace::dequeued();
+   }
+   if (FiFoWatermark::drained(getUsedBufferSize()) == true)
+   {
+      settleWatermarks();
+   }
+   return;
+}
+
+/**************************************************************************************************
+ * FUNCTION: void FIFO_AdvanceWriteCounter(...)
+ *************************************************************************************************/
+template<typename FiFoType, class FiFoStats, class FiFoTrace, class FiFoWatermark> inline void FiFo<FiFoType, FiFoStats, FiFoTrace, FiFoWatermark>::advanceWriteCounter(uint16_t bytes)
+{
+   uint32_t w;
+
+   w = (uint32_t) FIFO_GET_WRITE_COUNT(m_buffer) + bytes;
+   if (w >= FIFO_GET_BUFFER_SIZE(m_buffer))
+   {
+      w -= FIFO_GET_BUFFER_SIZE(m_buffer);
+      FIFO_SET_OVERFLOW_STATUS(m_buffer, true);
+      FiFoStats::wrapped();
+   }
+   FIFO_SET_WRITE_BUFFER(m_buffer, (uint16_t) w);
+   updateBufferStatus();
+   return;
+}
+
+/**************************************************************************************************
+ * FUNCTION: bool FIFO_IsElementAligned(...)
+ *************************************************************************************************/
+template<typename FiFoType, class FiFoStats, class FiFoTrace, class FiFoWatermark> inline bool FiFo<FiFoType, FiFoStats, FiFoTrace, FiFoWatermark>::isElementAligned(uint16_t index)
+{
+   return (((uintptr_t) m_buffer.bufferPtr % alignof(FiFoType)) == 0) &&
+          ((FIFO_GET_BUFFER_SIZE(m_buffer) % sizeof(FiFoType)) == 0) &&
+          ((index % sizeof(FiFoType)) == 0);
+}
+
 /**************************************************************************************************
  * FUNCTION: void FIFO_IncrementWriteCounter(...)
  *************************************************************************************************/
-template<typename FiFoType> inline void FiFo<FiFoType>::incrementWriteCounter(void)
+template<typename FiFoType, class FiFoStats, class FiFoTrace, class FiFoWatermark> inline void FiFo<FiFoType, FiFoStats, FiFoTrace, FiFoWatermark>::incrementWriteCounter(void)
 {
-   uint8_t size;
+   uint16_t size;
 
    size = FIFO_GET_WRITE_COUNT(m_buffer) + 1;
-   if(size > FIFO_GET_BUFFER_SIZE(m_buffer))
+   if(size >= FIFO_GET_BUFFER_SIZE(m_buffer))
    {
       size = 0;
       FIFO_SET_OVERFLOW_STATUS(m_buffer, true);
+      FiFoStats::wrapped();
    }
 
    FIFO_SET_WRITE_BUFFER(m_buffer, size);
@@ -398,12 +927,12 @@ template<typename FiFoType> inline void FiFo<FiFoType>::incrementWriteCounter(vo
 /**************************************************************************************************
  * FUNCTION: void FIFO_IncrementReadCounter(...)
  *************************************************************************************************/
-template<typename FiFoType> inline void FiFo<FiFoType>::incrementReadCounter(void)
+template<typename FiFoType, class FiFoStats, class FiFoTrace, class FiFoWatermark> inline void FiFo<FiFoType, FiFoStats, FiFoTrace, FiFoWatermark>::incrementReadCounter(void)
 {
-   uint8_t size;
+   uint16_t size;
 
    size = FIFO_GET_READ_COUNT(m_buffer) + 1;
-   if(size > FIFO_GET_BUFFER_SIZE(m_buffer))
+   if(size >= FIFO_GET_BUFFER_SIZE(m_buffer))
    {
       size = 0;
       FIFO_SET_OVERFLOW_STATUS(m_buffer, false);
@@ -416,7 +945,7 @@ template<typename FiFoType> inline void FiFo<FiFoType>::incrementReadCounter(voi
 /**************************************************************************************************
  * FUNCTION: void FIFO_UpdateBufferStatus(...)
  *************************************************************************************************/
-template<typename FiFoType> inline void FiFo<FiFoType>::updateBufferStatus(void)
+template<typename FiFoType, class FiFoStats, class FiFoTrace, class FiFoWatermark> inline void FiFo<FiFoType, FiFoStats, FiFoTrace, FiFoWatermark>::updateBufferStatus(void)
 {
    /************************************************************************
     *
@@ -440,11 +969,11 @@ template<typename FiFoType> inline void FiFo<FiFoType>::updateBufferStatus(void)
     *              b > a --- Error Write Overflow
     *
     ************************************************************************/
-   boolean o;
-   uint8_t w, r;
+   bool o;
+   uint16_t w, r;
    w = FIFO_GET_WRITE_COUNT(m_buffer);
    r = FIFO_GET_READ_COUNT(m_buffer);
-   o = (boolean) FIFO_GET_OVERFLOW_STATUS(m_buffer);
+   o = (bool) FIFO_GET_OVERFLOW_STATUS(m_buffer);
 
    if (o == false)
    {
@@ -479,10 +1008,47 @@ template<typename FiFoType> inline void FiFo<FiFoType>::updateBufferStatus(void)
    return;
 }
 
+/**************************************************************************************************
+ * FUNCTION: void FIFO_RecordWrite(...)
+ *************************************************************************************************/
+template<typename FiFoType, class FiFoStats, class FiFoTrace, class FiFoWatermark> inline void FiFo<FiFoType, FiFoStats, FiFoTrace, FiFoWatermark>::recordWrite(uint16_t count)
+{
+   if (FIFO_GET_BUFFER_STATUS(m_buffer) == FIFO_WRITE_OVERFLOW_ERROR)
+   {
+      FiFoStats::overwritten();
+   }
+   else
+   {
+      FiFoStats::pushed(count, getUsedBufferSize(), FIFO_GET_BUFFER_SIZE(m_buffer));
+      FiFoTrace::enqueued(count);
+   }
+   if (FiFoWatermark::filled(getUsedBufferSize()) == true)
+   {
+      settleWatermarks();
+   }
+   return;
+}
+
+/**************************************************************************************************
+ * FUNCTION: void FIFO_SettleWatermarks(...)
+ *************************************************************************************************/
+template<typename FiFoType, class FiFoStats, class FiFoTrace, class FiFoWatermark> inline void FiFo<FiFoType, FiFoStats, FiFoTrace, FiFoWatermark>::settleWatermarks(void)
+{
+   bool reported = true;
+
+   /* While one side reported a mark, the other side may have crossed the
+    * next one unnoticed, so check with the current fill level until stable */
+   while (reported == true)
+   {
+      reported = FiFoWatermark::drained(getUsedBufferSize()) || FiFoWatermark::filled(getUsedBufferSize());
+   }
+   return;
+}
+
 /**************************************************************************************************
  * FUNCTION: FIFO_BufferStatus_e FIFO_GetBufferStatus(...)
  *************************************************************************************************/
-template<typename FiFoType> inline uint16_t FiFo<FiFoType>::getBufferStatus(void)
+template<typename FiFoType, class FiFoStats, class FiFoTrace, class FiFoWatermark> inline uint16_t FiFo<FiFoType, FiFoStats, FiFoTrace, FiFoWatermark>::getBufferStatus(void)
 {
    return FIFO_GET_BUFFER_STATUS(m_buffer);
 }
@@ -490,18 +1056,18 @@ template<typename FiFoType> inline uint16_t FiFo<FiFoType>::getBufferStatus(void
 /**************************************************************************************************
  * FUNCTION: uint16_t FIFO_GetFreeBufferSpace(...)
  *************************************************************************************************/
-template<typename FiFoType> inline uint16_t FiFo<FiFoType>::getFreeBufferSpace(void)
+template<typename FiFoType, class FiFoStats, class FiFoTrace, class FiFoWatermark> inline uint16_t FiFo<FiFoType, FiFoStats, FiFoTrace, FiFoWatermark>::getFreeBufferSpace(void)
 {
-   boolean o;
-   uint8_t w, r;
+   bool o;
+   uint16_t w, r;
    uint16_t space = 0;
    w = FIFO_GET_WRITE_COUNT(m_buffer);
    r = FIFO_GET_READ_COUNT(m_buffer);
-   o = (boolean) FIFO_GET_OVERFLOW_STATUS(m_buffer);
+   o = (bool) FIFO_GET_OVERFLOW_STATUS(m_buffer);
 
    if (o == true)
    {
-      space = FIFO_GET_BUFFER_SIZE(m_buffer) - (r - w);
+      space = r - w;
    }
    else
    {
@@ -513,8 +1079,8 @@ template<typename FiFoType> inline uint16_t FiFo<FiFoType>::getFreeBufferSpace(v
 /**************************************************************************************************
  * FUNCTION: uint16_t DataAvailable(...)
  *************************************************************************************************/
-template<typename FiFoType>
-inline bool FiFo<FiFoType>::dataAvailable(void)
+template<typename FiFoType, class FiFoStats, class FiFoTrace, class FiFoWatermark>
+inline bool FiFo<FiFoType, FiFoStats, FiFoTrace, FiFoWatermark>::dataAvailable(void)
 {
    bool ret = false;
 
@@ -528,14 +1094,75 @@ inline bool FiFo<FiFoType>::dataAvailable(void)
 }
 
 
-template<typename FiFoType> inline uint16_t FiFo<FiFoType>::getSizeOfBuffer(void)
+template<typename FiFoType, class FiFoStats, class FiFoTrace, class FiFoWatermark> inline uint16_t FiFo<FiFoType, FiFoStats, FiFoTrace, FiFoWatermark>::getSizeOfBuffer(void)
 {
 	return FIFO_GET_BUFFER_SIZE(m_buffer);
 }
 
-template<typename FiFoType> inline uint16_t FiFo<FiFoType>::getUsedBufferSize(void)
+template<typename FiFoType, class FiFoStats, class FiFoTrace, class FiFoWatermark> inline uint16_t FiFo<FiFoType, FiFoStats, FiFoTrace, FiFoWatermark>::getUsedBufferSize(void)
+{
+	return getSizeOfBuffer() - getFreeBufferSpace();
+}
+
+/**************************************************************************************************
+ * FUNCTION: BufferStatistics_t FIFO_GetStatistics(...)
+ *************************************************************************************************/
+template<typename FiFoType, class FiFoStats, class FiFoTrace, class FiFoWatermark> inline BufferStatistics_t FiFo<FiFoType, FiFoStats, FiFoTrace, FiFoWatermark>::getStatistics(void)
 {
-	return getSizeOfBuffer() - getFreeBufferSpace() + 1;
+   BufferStatistics_t stats;
+
+   FiFoStats::snapshot(stats);
+   stats.capacity = FIFO_GET_BUFFER_SIZE(m_buffer);
+   return stats;
+}
+
+/**************************************************************************************************
+ * FUNCTION: void FIFO_ResetStatistics(...)
+ *************************************************************************************************/
+template<typename FiFoType, class FiFoStats, class FiFoTrace, class FiFoWatermark> inline void FiFo<FiFoType, FiFoStats, FiFoTrace, FiFoWatermark>::resetStatistics(void)
+{
+   FiFoStats::reset();
+   return;
+}
+
+/**************************************************************************************************
+ * FUNCTION: void FIFO_InitTrace(...)
+ *************************************************************************************************/
+template<typename FiFoType, class FiFoStats, class FiFoTrace, class FiFoWatermark> inline void FiFo<FiFoType, FiFoStats, FiFoTrace, FiFoWatermark>::initTrace(BufferTimestamp_t* stamps, uint16_t count)
+{
+   FiFoTrace::initTrace(stamps, count);
+   return;
+}
+
+/**************************************************************************************************
+ * FUNCTION: void FIFO_SetTraceName(...)
+ *************************************************************************************************/
+template<typename FiFoType, class FiFoStats, class FiFoTrace, class FiFoWatermark> inline void FiFo<FiFoType, FiFoStats, FiFoTrace, FiFoWatermark>::setTraceName(const char* name)
+{
+   FiFoTrace::traceName(name);
+   return;
+}
+
+/**************************************************************************************************
+ * FUNCTION: FIFO_Latency_t FIFO_GetLatency(...)
+ *************************************************************************************************/
+template<typename FiFoType, class FiFoStats, class FiFoTrace, class FiFoWatermark> inline FIFO_Latency_t FiFo<FiFoType, FiFoStats, FiFoTrace, FiFoWatermark>::getLatency(void)
+{
+   FIFO_Latency_t latency;
+
+   FiFoTrace::latency(latency);
+   return latency;
+}
+
+/**************************************************************************************************
+ * FUNCTION: void FIFO_SetWatermarks(...)
+ *************************************************************************************************/
+template<typename FiFoType, class FiFoStats, class FiFoTrace, class FiFoWatermark>
+inline void FiFo<FiFoType, FiFoStats, FiFoTrace, FiFoWatermark>::setWatermarks(uint16_t high, uint16_t low,
+         FIFO_WatermarkCallback_t callback, void* context)
+{
+   FiFoWatermark::watermarks(high, low, callback, context);
+   return;
 }
 
 #endif /* FIFO_H_ */
@@ -0,0 +1,353 @@
+#ifndef FIFO_CHANNEL_H
+#define FIFO_CHANNEL_H
+
+/*
+ * Coroutine channel on top of FiFo. Needs C++20 coroutines, the header is
+ * empty for older language modes so it can be included unconditionally.
+ */
+#if defined(__cpp_impl_coroutine) && __cpp_impl_coroutine >= 201902L
+
+#include <coroutine>
+#include <optional>
+#include <stddef.h>
+#include <stdint.h>
+#include <type_traits>
+#include <utility>
+#include "FiFo.h"
+
+/**
+ * @brief Suspended coroutine waiting in a run queue.
+ *
+ * The node lives in the awaiter inside the coroutine frame, so queueing
+ * never allocates and a queue cannot overflow. It must stay untouched until
+ * the coroutine is resumed.
+ */
+struct FiFoChannelTask
+{
+    std::coroutine_handle<> handle;
+    FiFoChannelTask *next;
+};
+
+/**
+ * @class FiFoChannelExecutor
+ * @brief Run queue of resumable coroutines.
+ *
+ * Default executor of FiFoChannel. schedule() links a suspended coroutine
+ * into an intrusive queue, run() resumes the queued coroutines until the
+ * queue is empty. Any type with a schedule(FiFoChannelTask &) member which
+ * resumes task.handle later (never from within schedule()) can be used
+ * instead, e.g. an adapter to an event loop.
+ */
+class FiFoChannelExecutor
+{
+public:
+    FiFoChannelExecutor() : m_head(NULL), m_tail(NULL) {}
+
+    FiFoChannelExecutor(const FiFoChannelExecutor &) = delete;
+    FiFoChannelExecutor &operator=(const FiFoChannelExecutor &) = delete;
+
+    /**
+     * @brief Queue a coroutine for resumption.
+     *
+     * @param task The suspended coroutine.
+     */
+    void schedule(FiFoChannelTask &task)
+    {
+        task.next = NULL;
+        if (m_tail != NULL)
+            m_tail->next = &task;
+        else
+            m_head = &task;
+        m_tail = &task;
+    }
+
+    /**
+     * @brief Resume queued coroutines until the queue is empty.
+     *
+     * @return uint32_t Number of resumed coroutines.
+     */
+    uint32_t run(void)
+    {
+        uint32_t count = 0;
+        while (m_head != NULL)
+        {
+            FiFoChannelTask *task = m_head;
+            m_head = task->next;
+            if (m_head == NULL)
+                m_tail = NULL;
+            // The task belongs to the coroutine frame, resume() may free it
+            task->handle.resume();
+            count++;
+        }
+        return count;
+    }
+
+private:
+    FiFoChannelTask *m_head; ///< Next coroutine to resume.
+    FiFoChannelTask *m_tail; ///< Last queued coroutine.
+};
+
+/**
+ * @class FiFoChannel
+ * @brief Awaitable channel between coroutines, backed by a FiFo.
+ *
+ * co_await read() returns the next element, or std::nullopt once the
+ * channel is closed and drained, and co_await write(v) stores an element.
+ * Neither suspends while the FiFo has data or space. A reader which finds
+ * the FiFo empty is suspended and queued; the next writer hands its
+ * element directly to that reader and switches to it by symmetric
+ * transfer, while the writer itself is passed to the executor. A writer
+ * which finds the FiFo full is suspended until a reader has made space,
+ * the reader moves the element into the FiFo and schedules the writer.
+ *
+ * The channel is not thread-safe, all coroutines using it have to run on
+ * the same executor thread.
+ *
+ * @tparam T The type of elements, must be trivially copyable since the
+ * FiFo stores them as bytes.
+ * @tparam Executor Executor type, see FiFoChannelExecutor.
+ * @tparam FiFoT The FiFo type.
+ */
+template <class T, class Executor = FiFoChannelExecutor, class FiFoT = FiFo<T> >
+class FiFoChannel
+{
+    static_assert(std::is_trivially_copyable<T>::value, "the FiFo copies elements as bytes");
+
+private:
+    typedef FiFoChannelTask Waiter;
+
+    struct WaiterQueue
+    {
+        Waiter *head;
+        Waiter *tail;
+
+        WaiterQueue() : head(NULL), tail(NULL) {}
+
+        void push(Waiter *w)
+        {
+            w->next = NULL;
+            if (tail != NULL)
+                tail->next = w;
+            else
+                head = w;
+            tail = w;
+        }
+
+        Waiter *pop(void)
+        {
+            Waiter *w = head;
+            if (w != NULL)
+            {
+                head = w->next;
+                if (head == NULL)
+                    tail = NULL;
+            }
+            return w;
+        }
+    };
+
+public:
+    /**
+     * @brief Awaiter returned by read().
+     */
+    class ReadAwaiter : private Waiter
+    {
+    public:
+        explicit ReadAwaiter(FiFoChannel &channel) : m_channel(channel), m_value(), m_ok(true) {}
+
+        bool await_ready(void) { return m_channel.tryRead(m_value, m_ok); }
+
+        void await_suspend(std::coroutine_handle<> handle)
+        {
+            this->handle = handle;
+            m_channel.m_readers.push(this);
+        }
+
+        /**
+         * @return The element, std::nullopt if the channel was closed and drained.
+         */
+        std::optional<T> await_resume(void)
+        {
+            std::optional<T> value;
+            if (m_ok)
+                value.emplace(std::move(m_value));
+            return value;
+        }
+
+    private:
+        friend class FiFoChannel;
+        FiFoChannel &m_channel;
+        T m_value;
+        bool m_ok;
+    };
+
+    /**
+     * @brief Awaiter returned by write().
+     */
+    class WriteAwaiter : private Waiter
+    {
+    public:
+        WriteAwaiter(FiFoChannel &channel, T value)
+            : m_channel(channel), m_value(std::move(value)), m_reader(NULL), m_ok(true) {}
+
+        bool await_ready(void)
+        {
+            bool ready = true;
+
+            if (m_channel.m_closed)
+            {
+                m_ok = false;
+            }
+            else if ((m_reader = static_cast<ReadAwaiter *>(m_channel.m_readers.pop())) != NULL)
+            {
+                // Hand over directly, await_suspend() switches to the reader
+                m_reader->m_value = std::move(m_value);
+                ready = false;
+            }
+            else if (m_channel.m_fifo.getFreeBufferSpace() >= sizeof(T))
+            {
+                m_channel.m_fifo.write(&m_value);
+            }
+            else
+            {
+                ready = false;
+            }
+            return ready;
+        }
+
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<> handle)
+        {
+            std::coroutine_handle<> next = std::noop_coroutine();
+
+            if (m_reader != NULL)
+            {
+                next = m_reader->handle;
+                this->handle = handle;
+                m_channel.m_executor.schedule(*this);
+            }
+            else
+            {
+                this->handle = handle;
+                m_channel.m_writers.push(this);
+            }
+            return next;
+        }
+
+        /**
+         * @return false if the channel was closed and the element was dropped.
+         */
+        bool await_resume(void) { return m_ok; }
+
+    private:
+        friend class FiFoChannel;
+        FiFoChannel &m_channel;
+        T m_value;
+        ReadAwaiter *m_reader;
+        bool m_ok;
+    };
+
+    /**
+     * @brief Construct a channel.
+     *
+     * @param fifo The initialised FiFo holding the buffered elements.
+     * @param executor The executor resuming woken coroutines.
+     */
+    FiFoChannel(FiFoT &fifo, Executor &executor)
+        : m_fifo(fifo), m_executor(executor), m_closed(false) {}
+
+    FiFoChannel(const FiFoChannel &) = delete;
+    FiFoChannel &operator=(const FiFoChannel &) = delete;
+
+    /**
+     * @brief Read the next element, suspends while the channel is empty.
+     *
+     * @return ReadAwaiter Awaitable yielding the element, or std::nullopt
+     * once the channel is closed and drained.
+     */
+    ReadAwaiter read(void) { return ReadAwaiter(*this); }
+
+    /**
+     * @brief Write an element, suspends while the channel is full.
+     *
+     * @param value The element to write.
+     * @return WriteAwaiter Awaitable yielding false if the channel is closed.
+     */
+    WriteAwaiter write(T value) { return WriteAwaiter(*this, std::move(value)); }
+
+    /**
+     * @brief Close the channel.
+     *
+     * Suspended writers are woken with false, suspended readers with
+     * std::nullopt.
+     * Buffered elements can still be read.
+     */
+    void close(void)
+    {
+        Waiter *w;
+
+        m_closed = true;
+        while ((w = m_writers.pop()) != NULL)
+        {
+            static_cast<WriteAwaiter *>(w)->m_ok = false;
+            m_executor.schedule(*w);
+        }
+        while ((w = m_readers.pop()) != NULL)
+        {
+            static_cast<ReadAwaiter *>(w)->m_ok = false;
+            m_executor.schedule(*w);
+        }
+    }
+
+    /**
+     * @brief Check if the channel is closed.
+     *
+     * @return true after close().
+     */
+    bool closed(void) { return m_closed; }
+
+private:
+    /**
+     * @brief Take an element without suspending, ok is false once the
+     * channel is closed and drained.
+     */
+    bool tryRead(T &value, bool &ok)
+    {
+        bool ready = true;
+        Waiter *w;
+
+        if (m_fifo.dataAvailable())
+        {
+            value = m_fifo.read();
+            if ((w = m_writers.pop()) != NULL)
+            {
+                m_fifo.write(&static_cast<WriteAwaiter *>(w)->m_value);
+                m_executor.schedule(*w);
+            }
+        }
+        else if ((w = m_writers.pop()) != NULL)
+        {
+            // FiFo without capacity for one element
+            value = std::move(static_cast<WriteAwaiter *>(w)->m_value);
+            m_executor.schedule(*w);
+        }
+        else if (m_closed)
+        {
+            ok = false;
+        }
+        else
+        {
+            ready = false;
+        }
+        return ready;
+    }
+
+    FiFoT &m_fifo;
+    Executor &m_executor;
+    WaiterQueue m_readers;
+    WaiterQueue m_writers;
+    bool m_closed;
+};
+
+#endif
+
+#endif
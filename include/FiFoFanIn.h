@@ -0,0 +1,248 @@
+#ifndef FIFO_FAN_IN_H
+#define FIFO_FAN_IN_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "FiFo.h"
+
+/**
+ * @class FiFoFanIn
+ * @brief Drains many FiFo channels into one consumer with weighted fairness.
+ *
+ * Every channel is a FiFo attached with a weight. The fan-in keeps a bitmap
+ * of channels holding data, which is set by write() / notify() and cleared
+ * when a channel runs empty, so dispatch() only touches channels with data.
+ * Channels are served in round-robin order with deficit round-robin: a
+ * visit adds weight credits to the channel and every dispatched element
+ * costs one credit. A visit serves at most burst elements; credits which
+ * are left when the burst limit is hit carry over to the next visit, up to
+ * one burst, so slow channels are not starved by busy ones.
+ *
+ * The fan-in and its FiFos are meant to be used from one context. Producers
+ * in other contexts must write through their own synchronisation and call
+ * notify() afterwards.
+ *
+ * @tparam T The type of elements stored in the channels.
+ * @tparam Channels Maximum number of channels.
+ * @tparam FiFoT The FiFo type of the channels.
+ */
+template <class T, uint16_t Channels, class FiFoT = FiFo<T> >
+class FiFoFanIn
+{
+public:
+    /**
+     * @brief Construct a fan-in without channels.
+     *
+     * @param burst Maximum number of elements served per channel visit.
+     */
+    explicit FiFoFanIn(uint16_t burst = 8) : m_burst(burst > 0 ? burst : 1), m_cursor(0)
+    {
+        for (uint16_t i = 0; i < WORDS; i++)
+        {
+            m_ready[i] = 0;
+        }
+        for (uint16_t i = 0; i < Channels; i++)
+        {
+            m_channels[i].fifo = NULL;
+            m_channels[i].weight = 0;
+            m_channels[i].deficit = 0;
+        }
+    }
+
+    /**
+     * @brief Attach a FiFo as channel.
+     *
+     * @param channel The channel number, smaller than Channels.
+     * @param fifo The FiFo of the channel, NULL detaches the channel.
+     * @param weight Credits the channel gets per visit.
+     * @return true if the channel was attached.
+     */
+    bool attach(uint16_t channel, FiFoT *fifo, uint16_t weight = 1)
+    {
+        bool ok = false;
+        if (channel < Channels)
+        {
+            m_channels[channel].fifo = fifo;
+            m_channels[channel].weight = weight > 0 ? weight : 1;
+            m_channels[channel].deficit = 0;
+            clearReady(channel);
+            if (fifo != NULL && fifo->dataAvailable())
+                setReady(channel);
+            ok = true;
+        }
+        return ok;
+    }
+
+    /**
+     * @brief Write an element into a channel and mark it ready.
+     *
+     * @param channel The channel number.
+     * @param data The element to write.
+     * @return true if the FiFo accepted the element.
+     */
+    bool write(uint16_t channel, T &data)
+    {
+        bool ok = false;
+        if (channel < Channels && m_channels[channel].fifo != NULL)
+        {
+            ok = m_channels[channel].fifo->write(&data);
+            if (ok)
+                setReady(channel);
+        }
+        return ok;
+    }
+
+    /**
+     * @brief Mark a channel ready after its FiFo was written directly.
+     *
+     * @param channel The channel number.
+     */
+    void notify(uint16_t channel)
+    {
+        if (channel < Channels && m_channels[channel].fifo != NULL &&
+            m_channels[channel].fifo->dataAvailable())
+            setReady(channel);
+    }
+
+    /**
+     * @brief Serve every ready channel once.
+     *
+     * Channels are visited in round-robin order, starting after the channel
+     * served last in the previous call.
+     *
+     * @param visitor Callable taking (uint16_t channel, T &element).
+     * @param budget Maximum number of elements to dispatch.
+     * @return Number of dispatched elements.
+     */
+    template <class Visitor>
+    uint32_t dispatch(Visitor visitor, uint32_t budget = 0xFFFFFFFFu)
+    {
+        uint32_t served = 0;
+        uint16_t start = m_cursor;
+
+        served += serveRange(start, Channels, visitor, budget - served);
+        if (served < budget)
+            served += serveRange(0, start, visitor, budget - served);
+        return served;
+    }
+
+    /**
+     * @brief Check if any channel holds data.
+     *
+     * @return true if at least one channel is ready.
+     */
+    bool dataAvailable(void)
+    {
+        bool ready = false;
+        for (uint16_t i = 0; i < WORDS && !ready; i++)
+        {
+            ready = m_ready[i] != 0;
+        }
+        return ready;
+    }
+
+    /**
+     * @brief Check if a channel is marked ready.
+     *
+     * @param channel The channel number.
+     * @return true if the channel is ready.
+     */
+    bool isReady(uint16_t channel)
+    {
+        return channel < Channels && (m_ready[channel / 32] & (1u << (channel % 32))) != 0;
+    }
+
+    /**
+     * @brief Get the burst limit.
+     *
+     * @return uint16_t Maximum number of elements served per visit.
+     */
+    uint16_t burst(void) { return m_burst; }
+
+    /**
+     * @brief Set the burst limit.
+     *
+     * @param burst Maximum number of elements served per visit.
+     */
+    void burst(uint16_t burst) { m_burst = burst > 0 ? burst : 1; }
+
+private:
+    static const uint16_t WORDS = (Channels + 31) / 32;
+
+    struct Channel
+    {
+        FiFoT *fifo;
+        uint16_t weight;
+        uint32_t deficit;
+    };
+
+    void setReady(uint16_t channel) { m_ready[channel / 32] |= (1u << (channel % 32)); }
+    void clearReady(uint16_t channel) { m_ready[channel / 32] &= ~(1u << (channel % 32)); }
+
+    /**
+     * @brief Serve the ready channels in [from, to).
+     */
+    template <class Visitor>
+    uint32_t serveRange(uint16_t from, uint16_t to, Visitor &visitor, uint32_t budget)
+    {
+        uint32_t served = 0;
+
+        while (from < to && served < budget)
+        {
+            uint16_t word = from / 32;
+            uint32_t bits = m_ready[word] & (0xFFFFFFFFu << (from % 32));
+            if (bits == 0)
+            {
+                from = (word + 1) * 32;
+                continue;
+            }
+
+            uint16_t channel = word * 32 + __builtin_ctz(bits);
+            if (channel >= to)
+                break;
+
+            served += serveChannel(channel, visitor, budget - served);
+            m_cursor = channel + 1 < Channels ? channel + 1 : 0;
+            from = channel + 1;
+        }
+        return served;
+    }
+
+    /**
+     * @brief Serve one visit of a ready channel.
+     */
+    template <class Visitor>
+    uint32_t serveChannel(uint16_t channel, Visitor &visitor, uint32_t budget)
+    {
+        Channel &c = m_channels[channel];
+        uint32_t served = 0;
+
+        c.deficit += c.weight;
+        while (c.deficit > 0 && served < m_burst && served < budget && c.fifo->dataAvailable())
+        {
+            T data = c.fifo->read();
+            c.deficit--;
+            served++;
+            visitor(channel, data);
+        }
+
+        if (!c.fifo->dataAvailable())
+        {
+            c.deficit = 0;
+            clearReady(channel);
+        }
+        else if (c.deficit > m_burst)
+        {
+            c.deficit = m_burst;
+        }
+        return served;
+    }
+
+private:
+    Channel m_channels[Channels]; ///< Attached channels.
+    uint32_t m_ready[WORDS];      ///< Bitmap of channels holding data.
+    uint16_t m_burst;             ///< Maximum number of elements per visit.
+    uint16_t m_cursor;            ///< Channel where the next dispatch starts.
+};
+
+#endif
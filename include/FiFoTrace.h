@@ -0,0 +1,326 @@
+#ifndef FIFO_TRACE_H
+#define FIFO_TRACE_H
+
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(__linux__)
+#include <time.h>
+#elif defined(ARDUINO)
+#include <Arduino.h>
+#else
+#include <chrono>
+#endif
+
+/**
+ * @brief Monotonic timestamp
+ *
+ * Linux: CLOCK_MONOTONIC in nanoseconds.
+ * ESP32: CPU cycle counter.
+ * Other Arduino targets: micros().
+ * Other hosts: std::chrono::steady_clock in nanoseconds.
+ */
+#if defined(__linux__)
+typedef uint64_t BufferTimestamp_t;
+
+inline BufferTimestamp_t bufferTimestamp(void)
+{
+   struct timespec ts;
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+#define BUFFER_TIMESTAMP_TO_NS(ticks)   ((uint64_t)(ticks))
+
+#elif defined(ARDUINO_ARCH_ESP32)
+typedef uint32_t BufferTimestamp_t;
+
+inline BufferTimestamp_t bufferTimestamp(void)
+{
+   return (BufferTimestamp_t)ESP.getCycleCount();
+}
+
+#define BUFFER_TIMESTAMP_TO_NS(ticks)   ((uint64_t)(ticks) * 1000u / (F_CPU / 1000000u))
+
+#elif defined(ARDUINO)
+typedef uint32_t BufferTimestamp_t;
+
+inline BufferTimestamp_t bufferTimestamp(void)
+{
+   return (BufferTimestamp_t)micros();
+}
+
+#define BUFFER_TIMESTAMP_TO_NS(ticks)   ((uint64_t)(ticks) * 1000u)
+
+#else
+typedef uint64_t BufferTimestamp_t;
+
+inline BufferTimestamp_t bufferTimestamp(void)
+{
+   return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+#define BUFFER_TIMESTAMP_TO_NS(ticks)   ((uint64_t)(ticks))
+
+#endif
+
+/**
+ * @brief Number of buckets of the latency histogram.
+ *
+ * Bucket i holds the delays in [2^(i - 1), 2^i) ns, bucket 0 holds 0 ns.
+ */
+#define FIFO_LATENCY_BUCKETS              33
+
+/**
+ * @brief Latency Summary
+ *
+ * Queueing delay of the elements read from a FiFo, in nanoseconds. The
+ * percentiles are the upper bound of the histogram bucket they fall into.
+ * Delays above 2^32 - 1 ns are clamped.
+ */
+typedef struct
+{
+   const char *name;
+   uint32_t count;
+   uint32_t dropped;
+   uint32_t p50;
+   uint32_t p99;
+   uint32_t max;
+} FIFO_Latency_t;
+
+/**
+ * @brief Export callback, called once per registered FiFo.
+ */
+typedef void (*FIFO_LatencyExport_t)(const FIFO_Latency_t &latency, void *context);
+
+/**
+ * @brief The FiFoNoTrace class
+ *
+ * Default trace policy of the FiFo. All hooks are empty.
+ */
+class FiFoNoTrace
+{
+public:
+    void initTrace(BufferTimestamp_t *stamps, uint16_t count) { (void)stamps; (void)count; }
+    void traceName(const char *name) { (void)name; }
+    void restartTrace(void) {}
+    void enqueued(uint16_t count) { (void)count; }
+    void dequeued(void) {}
+
+    void latency(FIFO_Latency_t &latency) const
+    {
+        latency = FIFO_Latency_t();
+    }
+};
+
+/**
+ * @brief The FiFoLatencyTrace class
+ *
+ * Trace policy which measures how long elements wait in a FiFo. write()
+ * stores a timestamp per element in a caller provided array which is used
+ * as a ring parallel to the FiFo data, so the element layout does not
+ * change. read() takes the oldest timestamp and adds the delay to a log2
+ * histogram. The producer owns the tail of the ring, the consumer the head;
+ * they only share the atomic pending count, so the FiFo may be written and
+ * read from different threads. The histogram is made of relaxed atomics
+ * written by the consumer only, so it can be exported from any thread at
+ * any time.
+ *
+ * Every trace registers itself in a global list once a name is set, see
+ * exportAll().
+ */
+class FiFoLatencyTrace
+{
+public:
+    FiFoLatencyTrace() : m_stamps(NULL), m_size(0), m_head(0), m_tail(0),
+                         m_name(NULL), m_next(NULL)
+    {
+        m_pending.store(0, std::memory_order_relaxed);
+        for (uint8_t i = 0; i < FIFO_LATENCY_BUCKETS; i++)
+        {
+            m_buckets[i].store(0, std::memory_order_relaxed);
+        }
+        m_dropped.store(0, std::memory_order_relaxed);
+        m_max.store(0, std::memory_order_relaxed);
+    }
+
+    ~FiFoLatencyTrace()
+    {
+        unregisterTrace();
+    }
+
+    FiFoLatencyTrace(const FiFoLatencyTrace &) = delete;
+    FiFoLatencyTrace &operator=(const FiFoLatencyTrace &) = delete;
+
+    /**
+     * @brief Hand over the timestamp storage.
+     *
+     * @param stamps array with one timestamp per element the FiFo can hold
+     * @param count number of entries in stamps
+     */
+    void initTrace(BufferTimestamp_t *stamps, uint16_t count)
+    {
+        m_stamps = stamps;
+        m_size = stamps != NULL ? count : 0;
+        restartTrace();
+    }
+
+    /**
+     * @brief Forget the pending timestamps, used when the FiFo is reset.
+     */
+    void restartTrace(void)
+    {
+        m_head = 0;
+        m_tail = 0;
+        m_pending.store(0, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Set the name used by exportAll() and register the trace.
+     *
+     * Registration must not run concurrently with exportAll().
+     */
+    void traceName(const char *name)
+    {
+        if (m_name == NULL && name != NULL)
+        {
+            m_next = registry();
+            registry() = this;
+        }
+        m_name = name;
+    }
+
+    /**
+     * @brief Stamp count elements written to the FiFo. Producer only.
+     */
+    void enqueued(uint16_t count)
+    {
+        BufferTimestamp_t now = bufferTimestamp();
+        uint16_t room = m_size - m_pending.load(std::memory_order_acquire);
+        uint16_t stamped = count < room ? count : room;
+
+        for (uint16_t i = 0; i < stamped; i++)
+        {
+            m_stamps[m_tail] = now;
+            m_tail = m_tail + 1 < m_size ? m_tail + 1 : 0;
+        }
+        m_pending.fetch_add(stamped, std::memory_order_release);
+
+        if (stamped < count)
+        {
+            m_dropped.store(m_dropped.load(std::memory_order_relaxed) + (count - stamped),
+                            std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * @brief Record the delay of the element read from the FiFo. Consumer only.
+     */
+    void dequeued(void)
+    {
+        if (m_pending.load(std::memory_order_acquire) > 0)
+        {
+            uint64_t delay = BUFFER_TIMESTAMP_TO_NS((BufferTimestamp_t)(bufferTimestamp() - m_stamps[m_head]));
+            uint32_t ns = delay > 0xFFFFFFFFu ? 0xFFFFFFFFu : (uint32_t)delay;
+            m_head = m_head + 1 < m_size ? m_head + 1 : 0;
+            m_pending.fetch_sub(1, std::memory_order_release);
+
+            uint8_t bucket = ns == 0 ? 0 : (uint8_t)(32 - __builtin_clz(ns));
+            m_buckets[bucket].store(m_buckets[bucket].load(std::memory_order_relaxed) + 1,
+                                    std::memory_order_relaxed);
+            if (ns > m_max.load(std::memory_order_relaxed))
+            {
+                m_max.store(ns, std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /**
+     * @brief Summarise the recorded delays.
+     */
+    void latency(FIFO_Latency_t &latency) const
+    {
+        uint32_t buckets[FIFO_LATENCY_BUCKETS];
+        uint32_t total = 0;
+
+        for (uint8_t i = 0; i < FIFO_LATENCY_BUCKETS; i++)
+        {
+            buckets[i] = m_buckets[i].load(std::memory_order_relaxed);
+            total += buckets[i];
+        }
+
+        latency.name = m_name;
+        latency.count = total;
+        latency.dropped = m_dropped.load(std::memory_order_relaxed);
+        latency.max = m_max.load(std::memory_order_relaxed);
+        latency.p50 = percentile(buckets, total, 50, latency.max);
+        latency.p99 = percentile(buckets, total, 99, latency.max);
+    }
+
+    /**
+     * @brief Call fn for every registered trace.
+     *
+     * @param fn export callback
+     * @param context user pointer passed to fn
+     */
+    static void exportAll(FIFO_LatencyExport_t fn, void *context)
+    {
+        for (FiFoLatencyTrace *t = registry(); t != NULL; t = t->m_next)
+        {
+            FIFO_Latency_t latency;
+            t->latency(latency);
+            fn(latency, context);
+        }
+    }
+
+private:
+    static FiFoLatencyTrace *&registry(void)
+    {
+        static FiFoLatencyTrace *head = NULL;
+        return head;
+    }
+
+    void unregisterTrace(void)
+    {
+        for (FiFoLatencyTrace **t = &registry(); *t != NULL; t = &(*t)->m_next)
+        {
+            if (*t == this)
+            {
+                *t = m_next;
+                break;
+            }
+        }
+    }
+
+    static uint32_t percentile(const uint32_t *buckets, uint32_t total, uint8_t p, uint32_t max)
+    {
+        uint64_t rank = (uint64_t)total * p / 100u;
+        uint32_t seen = 0;
+
+        for (uint8_t i = 0; i < FIFO_LATENCY_BUCKETS; i++)
+        {
+            seen += buckets[i];
+            if (seen > rank)
+            {
+                uint64_t upper = i == 0 ? 0 : ((uint64_t)1 << i) - 1;
+                return upper < max ? (uint32_t)upper : max;
+            }
+        }
+        return max;
+    }
+
+    BufferTimestamp_t *m_stamps;
+    uint16_t m_size;
+    uint16_t m_head;                   ///< Oldest stamp, consumer only.
+    uint16_t m_tail;                   ///< Next free stamp, producer only.
+    std::atomic<uint16_t> m_pending;   ///< Stamps not yet dequeued, shared.
+    const char *m_name;
+    FiFoLatencyTrace *m_next;
+    std::atomic<uint32_t> m_buckets[FIFO_LATENCY_BUCKETS];
+    std::atomic<uint32_t> m_dropped;
+    std::atomic<uint32_t> m_max;
+};
+
+#endif
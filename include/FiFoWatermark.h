@@ -0,0 +1,151 @@
+#ifndef FIFO_WATERMARK_H
+#define FIFO_WATERMARK_H
+
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Watermark reported to the callback.
+ */
+enum FIFO_Watermark_e
+{
+   FIFO_WATERMARK_HIGH = 0x00,
+   FIFO_WATERMARK_LOW,
+};
+
+/**
+ * @brief Watermark callback, called with the crossed mark and the used bytes.
+ */
+typedef void (*FIFO_WatermarkCallback_t)(FIFO_Watermark_e mark, uint16_t used, void *context);
+
+/**
+ * @brief The FiFoNoWatermark class
+ *
+ * Default watermark policy of the FiFo. All hooks are empty.
+ */
+class FiFoNoWatermark
+{
+public:
+    void watermarks(uint16_t high, uint16_t low, FIFO_WatermarkCallback_t callback, void *context)
+    {
+        (void)high;
+        (void)low;
+        (void)callback;
+        (void)context;
+    }
+    void restartWatermarks(void) {}
+    bool filled(uint16_t used) { (void)used; return false; }
+    bool drained(uint16_t used) { (void)used; return false; }
+};
+
+/**
+ * @brief The FiFoWatermarks class
+ *
+ * Watermark policy for event driven flow control. The FiFo starts below
+ * the high mark. Once a write makes the used size reach the high mark, the
+ * callback gets FIFO_WATERMARK_HIGH in the writing context; from then on
+ * only a read which lets the used size fall to the low mark or below
+ * reports FIFO_WATERMARK_LOW, in the reading context, and re-arms the high
+ * mark. So every crossing is reported exactly once and the band between
+ * the marks keeps the callback from toggling.
+ *
+ * The armed mark is one atomic state. A hook claims a crossing with a
+ * compare-exchange and holds the state while its callback runs, so the
+ * producer and the consumer, e.g. an ISR and a task, never report at the
+ * same time and the reports alternate. A crossing the other side made in
+ * the meantime is picked up by the reporting side: a hook returns true
+ * after it reported and the FiFo then checks both marks again.
+ */
+class FiFoWatermarks
+{
+public:
+    FiFoWatermarks() : m_high(0), m_low(0), m_callback(NULL), m_context(NULL)
+    {
+        m_state.store(WATERMARK_OFF, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Set the marks and the callback and re-arm the high mark.
+     *
+     * Must not run concurrently with the FiFo. A pending low mark is not
+     * reported, the caller resumes its flow control itself.
+     *
+     * @param high Used bytes which report FIFO_WATERMARK_HIGH, at least 1.
+     * @param low Used bytes which report FIFO_WATERMARK_LOW, clamped below high.
+     * @param callback Callback, NULL disables both marks.
+     * @param context Passed to callback.
+     */
+    void watermarks(uint16_t high, uint16_t low, FIFO_WatermarkCallback_t callback, void *context)
+    {
+        m_high = high > 0 ? high : 1;
+        m_low = low < m_high ? low : m_high - 1;
+        m_callback = callback;
+        m_context = context;
+        m_state.store(callback != NULL ? WATERMARK_ARMED_HIGH : WATERMARK_OFF, std::memory_order_seq_cst);
+    }
+
+    /**
+     * @brief Re-arm the high mark after initBuffer() emptied the FiFo.
+     *
+     * If the high mark was reported and the low mark is still pending, the
+     * empty FiFo crossed it: the callback gets FIFO_WATERMARK_LOW with 0
+     * used bytes, so a paused producer is resumed.
+     */
+    void restartWatermarks(void)
+    {
+        uint8_t previous = m_state.exchange(m_callback != NULL ? WATERMARK_ARMED_HIGH : WATERMARK_OFF,
+                                            std::memory_order_seq_cst);
+        if (previous == WATERMARK_ARMED_LOW && m_callback != NULL)
+            m_callback(FIFO_WATERMARK_LOW, 0, m_context);
+    }
+
+    /**
+     * @brief Hook after a write.
+     *
+     * @return true if the high mark was reported.
+     */
+    bool filled(uint16_t used)
+    {
+        return used >= m_high && report(WATERMARK_ARMED_HIGH, WATERMARK_ARMED_LOW, FIFO_WATERMARK_HIGH, used);
+    }
+
+    /**
+     * @brief Hook after a read.
+     *
+     * @return true if the low mark was reported.
+     */
+    bool drained(uint16_t used)
+    {
+        return used <= m_low && report(WATERMARK_ARMED_LOW, WATERMARK_ARMED_HIGH, FIFO_WATERMARK_LOW, used);
+    }
+
+private:
+    static const uint8_t WATERMARK_ARMED_HIGH = 0; ///< Waiting for the high mark.
+    static const uint8_t WATERMARK_ARMED_LOW = 1;  ///< High reported, waiting for the low mark.
+    static const uint8_t WATERMARK_REPORTING = 2;  ///< A callback runs.
+    static const uint8_t WATERMARK_OFF = 3;        ///< No callback.
+
+    /**
+     * @brief Claim the transition from armed to next and report mark.
+     */
+    bool report(uint8_t armed, uint8_t next, FIFO_Watermark_e mark, uint16_t used)
+    {
+        bool claimed = m_state.load(std::memory_order_relaxed) == armed &&
+                       m_state.compare_exchange_strong(armed, WATERMARK_REPORTING, std::memory_order_seq_cst);
+        if (claimed)
+        {
+            m_callback(mark, used, m_context);
+            m_state.store(next, std::memory_order_seq_cst);
+        }
+        return claimed;
+    }
+
+    std::atomic<uint8_t> m_state;        ///< Armed mark, see WATERMARK_ARMED_HIGH.
+    uint16_t m_high;                     ///< High mark in bytes.
+    uint16_t m_low;                      ///< Low mark in bytes.
+    FIFO_WatermarkCallback_t m_callback; ///< Callback, NULL if disabled.
+    void *m_context;                     ///< Callback context.
+};
+
+#endif
@@ -0,0 +1,497 @@
+#ifndef FIFO_WORK_POOL_H
+#define FIFO_WORK_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <stddef.h>
+#include <stdint.h>
+#include <thread>
+
+/**
+ * @brief Size of a cache line, the deque indices are kept on separate lines.
+ */
+#ifndef FIFO_CACHE_LINE_SIZE
+#define FIFO_CACHE_LINE_SIZE 64
+#endif
+
+/**
+ * @brief Maximum number of elements taken by one steal.
+ */
+#ifndef FIFO_WORK_STEAL_BATCH
+#define FIFO_WORK_STEAL_BATCH 32
+#endif
+
+/**
+ * @brief Rounds an idle worker polls, then yields, before it is parked.
+ */
+#ifndef FIFO_WORK_SPIN_ROUNDS
+#define FIFO_WORK_SPIN_ROUNDS 64
+#endif
+
+#ifndef FIFO_WORK_YIELD_ROUNDS
+#define FIFO_WORK_YIELD_ROUNDS 16
+#endif
+
+/**
+ * @class FiFoWorkDeque
+ * @brief Work-stealing deque over a caller provided buffer.
+ *
+ * Chase-Lev deque: the owner pushes and pops at the bottom without
+ * read-modify-write operations, other workers steal from the top. Unlike
+ * the classic algorithm a thief takes up to half of the elements at once.
+ * It first reserves the range with one CAS on the top word, re-reads the
+ * bottom to drop what the owner has taken in the meantime, copies the
+ * remaining elements and publishes the new top. While a range is reserved
+ * the owner does not pop into it and other thieves back off, so each
+ * victim has at most one batch steal in flight.
+ *
+ * The capacity is the largest power of two number of elements which fits
+ * into the buffer. Elements are copied with plain loads and stores, so T
+ * should be small and trivially copyable, e.g. a pointer or an index.
+ *
+ * @tparam T The type of elements.
+ */
+template <class T>
+class FiFoWorkDeque
+{
+public:
+    FiFoWorkDeque() : m_buffer(NULL), m_mask(0)
+    {
+        m_top.store(0, std::memory_order_relaxed);
+        m_bottom.store(0, std::memory_order_relaxed);
+    }
+
+    FiFoWorkDeque(const FiFoWorkDeque &) = delete;
+    FiFoWorkDeque &operator=(const FiFoWorkDeque &) = delete;
+
+    /**
+     * @brief Init the deque, like FiFo::initBuffer().
+     *
+     * Must not run concurrently with any other member.
+     *
+     * @param buffer Storage, aligned for T.
+     * @param size Size of the storage in bytes.
+     */
+    void initBuffer(uint8_t *buffer, uint16_t size)
+    {
+        uint32_t count = buffer != NULL ? size / sizeof(T) : 0;
+        uint32_t capacity = 1;
+
+        while (capacity * 2 <= count)
+        {
+            capacity *= 2;
+        }
+        m_buffer = (T *)buffer;
+        m_mask = count > 0 ? capacity - 1 : 0;
+        m_top.store(0, std::memory_order_relaxed);
+        m_bottom.store(0, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Push an element at the bottom. Owner only.
+     *
+     * @param data The element.
+     * @return false if the deque is full or not initialised.
+     */
+    bool write(const T &data)
+    {
+        bool ok = false;
+        uint32_t b = m_bottom.load(std::memory_order_relaxed);
+        uint32_t t = topIndex(m_top.load(std::memory_order_acquire));
+
+        if (m_buffer != NULL && b - t <= m_mask)
+        {
+            m_buffer[b & m_mask] = data;
+            m_bottom.store(b + 1, std::memory_order_release);
+            ok = true;
+        }
+        return ok;
+    }
+
+    /**
+     * @brief Pop the element pushed last. Owner only.
+     *
+     * @param data Receives the element.
+     * @return false if the deque is empty or the remaining elements are
+     * being stolen.
+     */
+    bool read(T &data)
+    {
+        bool ok = false;
+        uint32_t b = m_bottom.load(std::memory_order_relaxed) - 1;
+
+        m_bottom.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        uint64_t top = m_top.load(std::memory_order_relaxed);
+        int32_t left = (int32_t)(b - (topIndex(top) + reserved(top)));
+
+        if (left > 0)
+        {
+            data = m_buffer[b & m_mask];
+            ok = true;
+        }
+        else if (left == 0 && reserved(top) == 0)
+        {
+            // Last element, race against the thieves for it
+            data = m_buffer[b & m_mask];
+            ok = m_top.compare_exchange_strong(top, makeTop(topIndex(top) + 1, 0),
+                                               std::memory_order_seq_cst,
+                                               std::memory_order_relaxed);
+            m_bottom.store(b + 1, std::memory_order_relaxed);
+        }
+        else
+        {
+            m_bottom.store(b + 1, std::memory_order_relaxed);
+        }
+        return ok;
+    }
+
+    /**
+     * @brief Steal up to half of the elements from the top. Any thread.
+     *
+     * @param out Receives the stolen elements, oldest first.
+     * @param max_n Maximum number of elements to steal.
+     * @return Number of stolen elements.
+     */
+    uint32_t steal(T *out, uint32_t max_n)
+    {
+        uint64_t top = m_top.load(std::memory_order_acquire);
+        uint32_t t = topIndex(top);
+        uint32_t n = 0;
+
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int32_t size = (int32_t)(m_bottom.load(std::memory_order_acquire) - t);
+
+        if (reserved(top) == 0 && size > 0 && max_n > 0)
+        {
+            n = ((uint32_t)size + 1) / 2;
+            if (n > max_n)
+                n = max_n;
+
+            if (m_top.compare_exchange_strong(top, makeTop(t, n),
+                                              std::memory_order_seq_cst,
+                                              std::memory_order_relaxed))
+            {
+                // Elements the owner popped before seeing the reservation
+                // are below the bottom it has published by now
+                int32_t left = (int32_t)(m_bottom.load(std::memory_order_seq_cst) - t);
+                if (left < (int32_t)n)
+                    n = left > 0 ? (uint32_t)left : 0;
+
+                for (uint32_t i = 0; i < n; i++)
+                {
+                    out[i] = m_buffer[(t + i) & m_mask];
+                }
+                m_top.store(makeTop(t + n, 0), std::memory_order_seq_cst);
+            }
+            else
+            {
+                n = 0;
+            }
+        }
+        return n;
+    }
+
+    /**
+     * @brief Check if the deque holds data. Any thread, approximate.
+     *
+     * @return true if elements are available.
+     */
+    bool dataAvailable(void) const
+    {
+        uint32_t t = topIndex(m_top.load(std::memory_order_acquire));
+        return (int32_t)(m_bottom.load(std::memory_order_acquire) - t) > 0;
+    }
+
+    /**
+     * @brief Get the number of elements. Any thread, approximate.
+     *
+     * @return uint32_t Number of elements.
+     */
+    uint32_t getUsedBufferSize(void) const
+    {
+        uint32_t t = topIndex(m_top.load(std::memory_order_acquire));
+        int32_t size = (int32_t)(m_bottom.load(std::memory_order_acquire) - t);
+        return size > 0 ? (uint32_t)size : 0;
+    }
+
+    /**
+     * @brief Get the number of free slots. Owner only.
+     *
+     * A range reserved by a thief still occupies its slots until the steal
+     * completes. Thieves only ever free slots, so the owner can write at
+     * least this many elements.
+     *
+     * @return uint32_t Number of elements which can be written.
+     */
+    uint32_t getFreeBufferSpace(void) const
+    {
+        uint32_t used = m_bottom.load(std::memory_order_relaxed) - topIndex(m_top.load(std::memory_order_acquire));
+        return m_buffer != NULL && used <= m_mask ? m_mask + 1 - used : 0;
+    }
+
+    /**
+     * @brief Get the capacity.
+     *
+     * @return uint32_t Number of elements the deque can hold.
+     */
+    uint32_t getSizeOfBuffer(void) const { return m_buffer != NULL ? m_mask + 1 : 0; }
+
+private:
+    // Top word: index in the upper, reserved count in the lower half
+    static uint64_t makeTop(uint32_t index, uint32_t count) { return ((uint64_t)index << 32) | count; }
+    static uint32_t topIndex(uint64_t top) { return (uint32_t)(top >> 32); }
+    static uint32_t reserved(uint64_t top) { return (uint32_t)top; }
+
+    T *m_buffer;                                                   ///< Element storage.
+    uint32_t m_mask;                                               ///< Capacity - 1.
+    alignas(FIFO_CACHE_LINE_SIZE) std::atomic<uint64_t> m_top;     ///< Written by thieves.
+    alignas(FIFO_CACHE_LINE_SIZE) std::atomic<uint32_t> m_bottom;  ///< Written by the owner.
+};
+
+/**
+ * @class FiFoWorkPool
+ * @brief Work distribution over one FiFoWorkDeque per worker.
+ *
+ * Every worker writes new work into its own deque and reads from it in LIFO
+ * order, so the common path touches only cache lines owned by the worker.
+ * A worker whose deque is empty steals a batch from the other workers,
+ * starting at a random victim, keeps the first stolen element and pushes
+ * the rest into its own deque. wait() polls, then yields and finally parks
+ * the worker on a condition variable. Writers only check one counter to
+ * see whether a worker is parked and take the lock only then.
+ *
+ * @tparam T The type of elements, see FiFoWorkDeque.
+ * @tparam Workers Number of workers.
+ */
+template <class T, uint16_t Workers>
+class FiFoWorkPool
+{
+public:
+    FiFoWorkPool() : m_sleepers(0), m_stop(false)
+    {
+        for (uint16_t i = 0; i < Workers; i++)
+        {
+            m_workers[i].spilled = 0;
+            m_workers[i].seed = 2463534242u + i * 0x9E3779B9u;
+        }
+    }
+
+    FiFoWorkPool(const FiFoWorkPool &) = delete;
+    FiFoWorkPool &operator=(const FiFoWorkPool &) = delete;
+
+    /**
+     * @brief Hand over the deque storage of a worker.
+     *
+     * Must be called for every worker before the workers are started.
+     *
+     * @param worker The worker number, smaller than Workers.
+     * @param buffer Storage, aligned for T.
+     * @param size Size of the storage in bytes.
+     * @return true if the worker number is valid.
+     */
+    bool initWorker(uint16_t worker, uint8_t *buffer, uint16_t size)
+    {
+        bool ok = false;
+        if (worker < Workers)
+        {
+            m_workers[worker].deque.initBuffer(buffer, size);
+            m_workers[worker].spilled = 0;
+            ok = true;
+        }
+        return ok;
+    }
+
+    /**
+     * @brief Add work to the deque of a worker. Called by that worker, or
+     * by a single feeding thread before the workers run.
+     *
+     * @param worker The worker number.
+     * @param data The element.
+     * @return false if the deque is full, the caller should run the work
+     * itself.
+     */
+    bool write(uint16_t worker, const T &data)
+    {
+        bool ok = worker < Workers && m_workers[worker].deque.write(data);
+        if (ok)
+        {
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (m_sleepers.load(std::memory_order_relaxed) > 0)
+            {
+                std::lock_guard<std::mutex> guard(m_lock);
+                m_wakeup.notify_one();
+            }
+        }
+        return ok;
+    }
+
+    /**
+     * @brief Take work without blocking. Called by the worker itself.
+     *
+     * @param worker The worker number.
+     * @param data Receives the element.
+     * @return false if no work was found.
+     */
+    bool read(uint16_t worker, T &data)
+    {
+        bool ok = false;
+        if (worker < Workers)
+        {
+            ok = unspill(worker, data) || m_workers[worker].deque.read(data) || stealFor(worker, data);
+        }
+        return ok;
+    }
+
+    /**
+     * @brief Take work, park the worker while there is none.
+     *
+     * @param worker The worker number.
+     * @param data Receives the element.
+     * @return false once shutdown() was called and no work was found.
+     */
+    bool wait(uint16_t worker, T &data)
+    {
+        uint32_t round = 0;
+
+        while (!read(worker, data))
+        {
+            if (m_stop.load(std::memory_order_acquire))
+                return false;
+
+            if (round < FIFO_WORK_SPIN_ROUNDS)
+            {
+                round++;
+            }
+            else if (round < FIFO_WORK_SPIN_ROUNDS + FIFO_WORK_YIELD_ROUNDS)
+            {
+                round++;
+                std::this_thread::yield();
+            }
+            else
+            {
+                park();
+                round = 0;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief Wake all parked workers and make wait() return false once the
+     * work is done.
+     */
+    void shutdown(void)
+    {
+        m_stop.store(true, std::memory_order_release);
+        std::lock_guard<std::mutex> guard(m_lock);
+        m_wakeup.notify_all();
+    }
+
+    /**
+     * @brief Check if any worker has work queued. Approximate.
+     *
+     * @return true if at least one deque holds data.
+     */
+    bool dataAvailable(void) const
+    {
+        bool ready = false;
+        for (uint16_t i = 0; i < Workers && !ready; i++)
+        {
+            ready = m_workers[i].deque.dataAvailable();
+        }
+        return ready;
+    }
+
+    /**
+     * @brief Get the deque of a worker, e.g. to check its fill level.
+     *
+     * @param worker The worker number, smaller than Workers.
+     * @return FiFoWorkDeque<T>& The deque.
+     */
+    FiFoWorkDeque<T> &deque(uint16_t worker) { return m_workers[worker].deque; }
+
+private:
+    struct Worker
+    {
+        FiFoWorkDeque<T> deque;
+        T spill[FIFO_WORK_STEAL_BATCH]; ///< Stolen elements the deque did not take.
+        uint32_t spilled;
+        uint32_t seed;
+    };
+
+    /**
+     * @brief Take an element kept back by stealFor(). Worker only.
+     */
+    bool unspill(uint16_t worker, T &data)
+    {
+        Worker &self = m_workers[worker];
+        bool ok = self.spilled > 0;
+        if (ok)
+            data = self.spill[--self.spilled];
+        return ok;
+    }
+
+    /**
+     * @brief Steal a batch from the other workers into the own deque.
+     *
+     * The batch is limited to the free space of the own deque, which may
+     * still be partly reserved by a thief. Elements the deque rejects anyway
+     * are kept in the spill area and read before the deque.
+     */
+    bool stealFor(uint16_t worker, T &data)
+    {
+        T batch[FIFO_WORK_STEAL_BATCH];
+        Worker &self = m_workers[worker];
+        uint32_t max_n = self.deque.getFreeBufferSpace() + 1;
+        uint32_t n = 0;
+
+        if (max_n > FIFO_WORK_STEAL_BATCH)
+            max_n = FIFO_WORK_STEAL_BATCH;
+
+        self.seed ^= self.seed << 13;
+        self.seed ^= self.seed >> 17;
+        self.seed ^= self.seed << 5;
+
+        uint16_t victim = (uint16_t)(self.seed % Workers);
+        for (uint16_t i = 0; i < Workers && n == 0; i++)
+        {
+            if (victim != worker)
+                n = m_workers[victim].deque.steal(batch, max_n);
+            victim = victim + 1 < Workers ? victim + 1 : 0;
+        }
+
+        if (n > 0)
+        {
+            data = batch[0];
+            for (uint32_t i = n - 1; i > 0; i--)
+            {
+                if (!self.deque.write(batch[i]))
+                    self.spill[self.spilled++] = batch[i];
+            }
+        }
+        return n > 0;
+    }
+
+    /**
+     * @brief Sleep until work is written or the pool is shut down.
+     */
+    void park(void)
+    {
+        std::unique_lock<std::mutex> guard(m_lock);
+        m_sleepers.fetch_add(1, std::memory_order_seq_cst);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (!dataAvailable() && !m_stop.load(std::memory_order_acquire))
+            m_wakeup.wait(guard);
+        m_sleepers.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    Worker m_workers[Workers];                                     ///< Per worker state.
+    alignas(FIFO_CACHE_LINE_SIZE) std::atomic<uint32_t> m_sleepers; ///< Number of parked workers.
+    std::atomic<bool> m_stop;                                      ///< Set by shutdown().
+    std::mutex m_lock;                                             ///< Protects parking.
+    std::condition_variable m_wakeup;                              ///< Parked workers wait here.
+};
+
+#endif
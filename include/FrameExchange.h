@@ -0,0 +1,266 @@
+#ifndef FRAME_EXCHANGE_H
+#define FRAME_EXCHANGE_H
+
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Maximum number of frames a FrameExchange manages.
+ */
+#ifndef FRAME_EXCHANGE_MAX_FRAMES
+#define FRAME_EXCHANGE_MAX_FRAMES 8
+#endif
+
+/**
+ * @brief Frame Exchange Mode
+ */
+enum FRAME_ExchangeMode_e
+{
+   FRAME_EXCHANGE_QUEUE = 0x00,  ///< Every published frame is read, the producer waits for free frames.
+   FRAME_EXCHANGE_LATEST,        ///< Triple buffer, the consumer gets the newest frame, older ones are skipped.
+};
+
+/**
+ * @class FrameExchange
+ * @brief Hands whole frame buffers from one producer to one consumer.
+ *
+ * Like FiFo::initBuffer() the storage comes from the caller, here as N
+ * separate frame buffers, e.g. DMA buffers of a camera, I2S or ADC driver.
+ * The producer fills the frame it got from acquire_write() in place and
+ * hands it over with publish(); the consumer processes the frame from
+ * acquire_read() in place and gives it back with release(). Frames are
+ * passed by pointer and never copied.
+ *
+ * FRAME_EXCHANGE_QUEUE passes every frame in order: with two frames it is
+ * a ping-pong buffer, the producer fills one while the consumer processes
+ * the other. acquire_write() returns NULL while all frames wait for the
+ * consumer.
+ *
+ * FRAME_EXCHANGE_LATEST is a triple buffer and uses three frames. The
+ * producer always owns one frame, the consumer one and the third is the
+ * shared slot. publish() swaps the producer frame with the shared slot in
+ * a single atomic exchange, acquire_read() swaps the consumer frame with it
+ * once a new frame arrived. A frame which is replaced before the consumer
+ * took it is dropped, so a lagging consumer always sees the latest frame.
+ *
+ * One producer and one consumer may run in different threads or in an
+ * interrupt and a task.
+ */
+class FrameExchange
+{
+public:
+    FrameExchange() : m_count(0), m_frameSize(0), m_mode(FRAME_EXCHANGE_QUEUE), m_back(0), m_front(0),
+                      m_writing(false), m_reading(false)
+    {
+        m_shared.store(0, std::memory_order_relaxed);
+        m_written.store(0, std::memory_order_relaxed);
+        m_read.store(0, std::memory_order_relaxed);
+        m_dropped.store(0, std::memory_order_relaxed);
+    }
+
+    FrameExchange(const FrameExchange &) = delete;
+    FrameExchange &operator=(const FrameExchange &) = delete;
+
+    /**
+     * @brief Init the exchange with caller provided frames.
+     *
+     * Must not run concurrently with any other member.
+     *
+     * @param frames Frame buffers, at least 2 for FRAME_EXCHANGE_QUEUE and
+     * 3 for FRAME_EXCHANGE_LATEST, at most FRAME_EXCHANGE_MAX_FRAMES.
+     * FRAME_EXCHANGE_LATEST only uses the first 3.
+     * @param count Number of frame buffers.
+     * @param frameSize Size of every frame buffer in bytes.
+     * @param mode Exchange mode.
+     * @return false if there are too few frames, the exchange is unusable.
+     */
+    bool initBuffers(uint8_t *const *frames, uint8_t count, uint32_t frameSize,
+                     FRAME_ExchangeMode_e mode = FRAME_EXCHANGE_QUEUE)
+    {
+        uint8_t needed = mode == FRAME_EXCHANGE_LATEST ? 3 : 2;
+        bool ok = frames != NULL && count >= needed;
+
+        if (mode == FRAME_EXCHANGE_LATEST && count > 3)
+            count = 3;
+        if (count > FRAME_EXCHANGE_MAX_FRAMES)
+            count = FRAME_EXCHANGE_MAX_FRAMES;
+
+        m_count = ok ? count : 0;
+        m_frameSize = frameSize;
+        m_mode = mode;
+        for (uint8_t i = 0; i < m_count; i++)
+        {
+            m_frames[i] = frames[i];
+            m_lengths[i] = 0;
+        }
+
+        // Latest mode: producer owns frame 0, the shared slot holds 1, the consumer 2
+        m_back = 0;
+        m_front = 2;
+        m_writing = false;
+        m_reading = false;
+        m_shared.store(1, std::memory_order_relaxed);
+        m_written.store(0, std::memory_order_relaxed);
+        m_read.store(0, std::memory_order_relaxed);
+        m_dropped.store(0, std::memory_order_relaxed);
+        return ok;
+    }
+
+    /**
+     * @brief Get a frame to fill. Producer only.
+     *
+     * Calling it again before publish() returns the same frame.
+     *
+     * @return uint8_t* The frame, NULL if no frame is free or not initialised.
+     */
+    uint8_t *acquire_write(void)
+    {
+        uint8_t *frame = NULL;
+        if (m_count > 0)
+        {
+            if (m_mode == FRAME_EXCHANGE_LATEST)
+            {
+                m_writing = true;
+            }
+            else
+            {
+                uint8_t w = m_written.load(std::memory_order_relaxed);
+                uint8_t r = m_read.load(std::memory_order_acquire);
+                m_back = (uint8_t)(w % m_count);
+                m_writing = distance(r, w) < m_count;
+            }
+            frame = m_writing ? m_frames[m_back] : NULL;
+        }
+        return frame;
+    }
+
+    /**
+     * @brief Hand the frame from acquire_write() to the consumer. Producer only.
+     *
+     * @param length Number of valid bytes in the frame.
+     */
+    void publish(uint32_t length)
+    {
+        if (m_writing)
+        {
+            m_lengths[m_back] = length < m_frameSize ? length : m_frameSize;
+            if (m_mode == FRAME_EXCHANGE_LATEST)
+            {
+                uint8_t previous = m_shared.exchange((uint8_t)(m_back | FRESH), std::memory_order_acq_rel);
+                if ((previous & FRESH) != 0)
+                    m_dropped.fetch_add(1, std::memory_order_relaxed);
+                m_back = (uint8_t)(previous & ~FRESH);
+            }
+            else
+            {
+                m_written.store(next(m_written.load(std::memory_order_relaxed)), std::memory_order_release);
+            }
+            m_writing = false;
+        }
+    }
+
+    /**
+     * @brief Hand the whole frame from acquire_write() to the consumer.
+     */
+    void publish(void) { publish(m_frameSize); }
+
+    /**
+     * @brief Get the next frame to process. Consumer only.
+     *
+     * Calling it again before release() returns the same frame.
+     *
+     * @param length Receives the number of valid bytes if not NULL.
+     * @return const uint8_t* The frame, NULL if no new frame was published.
+     */
+    const uint8_t *acquire_read(uint32_t *length = NULL)
+    {
+        const uint8_t *frame = NULL;
+        if (m_count > 0 && !m_reading)
+        {
+            if (m_mode == FRAME_EXCHANGE_LATEST)
+            {
+                if ((m_shared.load(std::memory_order_relaxed) & FRESH) != 0)
+                {
+                    m_front = (uint8_t)(m_shared.exchange(m_front, std::memory_order_acq_rel) & ~FRESH);
+                    m_reading = true;
+                }
+            }
+            else
+            {
+                uint8_t r = m_read.load(std::memory_order_relaxed);
+                uint8_t w = m_written.load(std::memory_order_acquire);
+                m_front = (uint8_t)(r % m_count);
+                m_reading = w != r;
+            }
+        }
+        if (m_reading)
+        {
+            frame = m_frames[m_front];
+            if (length != NULL)
+                *length = m_lengths[m_front];
+        }
+        return frame;
+    }
+
+    /**
+     * @brief Give the frame from acquire_read() back. Consumer only.
+     */
+    void release(void)
+    {
+        if (m_reading && m_mode == FRAME_EXCHANGE_QUEUE)
+            m_read.store(next(m_read.load(std::memory_order_relaxed)), std::memory_order_release);
+        m_reading = false;
+    }
+
+    /**
+     * @brief Get the number of frames replaced before the consumer took them.
+     *
+     * @return uint32_t The number of dropped frames, always 0 in queue mode.
+     */
+    uint32_t dropped(void) const { return m_dropped.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Get the number of managed frames.
+     *
+     * @return uint8_t The number of frames, 0 if not initialised.
+     */
+    uint8_t frames(void) const { return m_count; }
+
+    /**
+     * @brief Get the frame size.
+     *
+     * @return uint32_t Size of every frame in bytes.
+     */
+    uint32_t frameSize(void) const { return m_frameSize; }
+
+private:
+    static const uint8_t FRESH = 0x80; ///< Shared slot holds an unread frame.
+
+    /**
+     * @brief Queue mode counters run modulo twice the frame count, so a
+     * full and an empty queue differ and the frame index never jumps.
+     */
+    uint8_t next(uint8_t counter) const { return (uint8_t)(counter + 1 < 2 * m_count ? counter + 1 : 0); }
+
+    uint8_t distance(uint8_t from, uint8_t to) const
+    {
+        return (uint8_t)(to >= from ? to - from : to + 2 * m_count - from);
+    }
+
+    uint8_t *m_frames[FRAME_EXCHANGE_MAX_FRAMES];  ///< Caller provided frames.
+    uint32_t m_lengths[FRAME_EXCHANGE_MAX_FRAMES]; ///< Valid bytes per frame.
+    uint8_t m_count;                               ///< Number of frames.
+    uint32_t m_frameSize;                          ///< Size of every frame.
+    FRAME_ExchangeMode_e m_mode;                   ///< Exchange mode.
+    uint8_t m_back;                                ///< Frame of the producer.
+    uint8_t m_front;                               ///< Frame of the consumer.
+    bool m_writing;                                ///< Producer holds m_back.
+    bool m_reading;                                ///< Consumer holds m_front.
+    std::atomic<uint8_t> m_shared;                 ///< Latest mode: shared frame and FRESH flag.
+    std::atomic<uint8_t> m_written;                ///< Queue mode: published frames modulo 2 * m_count.
+    std::atomic<uint8_t> m_read;                   ///< Queue mode: released frames modulo 2 * m_count.
+    std::atomic<uint32_t> m_dropped;               ///< Latest mode: number of skipped frames.
+};
+
+#endif
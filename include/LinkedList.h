@@ -2,7 +2,10 @@
 #define LINKED_LIST_H
 
 
+#include <stddef.h>
 #include <stdint.h>
+#include <iterator>
+#include <type_traits>
 
 /**
  * @brief The ListEntry class
@@ -27,12 +30,24 @@ public:
      */
     T *data(void) { return &m_data; }
 
+    /**
+     * @brief data
+     * @return
+     */
+    const T *data(void) const { return &m_data; }
+
     /**
      * @brief next
      * @return
      */
     ListEntry<T> *next(void) { return m_next; }
 
+    /**
+     * @brief next
+     * @return
+     */
+    const ListEntry<T> *next(void) const { return m_next; }
+
     /**
      * @brief next
      * @param next
@@ -43,7 +58,7 @@ public:
      * @brief isNext
      * @return
      */
-    bool isNext(void) { return m_next != NULL ? true : false; }
+    bool isNext(void) const { return m_next != NULL ? true : false; }
 
     void reset_next(void) { m_next = NULL; }
 
@@ -52,6 +67,68 @@ private:
     ListEntry<T> *m_next;
 };
 
+/**
+ * @brief The ListIterator class
+ *
+ * Forward iterator over a chain of ListEntry objects. The iterator only
+ * holds the current entry, so any number of iterators can walk the same or
+ * different lists at the same time. Elements are accessed in place.
+ */
+template <class T, class EntryType, class ValueType>
+class ListIterator
+{
+public:
+    typedef std::forward_iterator_tag iterator_category;
+    typedef T value_type;
+    typedef ptrdiff_t difference_type;
+    typedef ValueType *pointer;
+    typedef ValueType &reference;
+
+    ListIterator() : m_entry(NULL) {}
+    explicit ListIterator(EntryType *entry) : m_entry(entry) {}
+
+    /**
+     * @brief Conversion from iterator to const_iterator.
+     *
+     * Only takes part in overload resolution if this is the const variant
+     * of the other iterator, so const_iterator does not convert back.
+     */
+    template <class OtherEntry, class OtherValue,
+              typename std::enable_if<!std::is_const<OtherValue>::value &&
+                                          std::is_same<const OtherEntry, EntryType>::value &&
+                                          std::is_same<const OtherValue, ValueType>::value,
+                                      int>::type = 0>
+    ListIterator(const ListIterator<T, OtherEntry, OtherValue> &other) : m_entry(other.entry()) {}
+
+    reference operator*() const { return *m_entry->data(); }
+    pointer operator->() const { return m_entry->data(); }
+
+    ListIterator &operator++()
+    {
+        m_entry = m_entry->next();
+        return *this;
+    }
+
+    ListIterator operator++(int)
+    {
+        ListIterator tmp(*this);
+        m_entry = m_entry->next();
+        return tmp;
+    }
+
+    bool operator==(const ListIterator &other) const { return m_entry == other.m_entry; }
+    bool operator!=(const ListIterator &other) const { return m_entry != other.m_entry; }
+
+    /**
+     * @brief entry
+     * @return the entry the iterator points to, NULL for end()
+     */
+    EntryType *entry(void) const { return m_entry; }
+
+private:
+    EntryType *m_entry;
+};
+
 /**
  * @brief The LinkedList class
  */
@@ -59,6 +136,9 @@ template <class T>
 class LinkedList
 {
 public:
+    typedef ListIterator<T, ListEntry<T>, T> iterator;
+    typedef ListIterator<T, const ListEntry<T>, const T> const_iterator;
+
     /**
      * @brief LinkedList
      */
@@ -93,7 +173,14 @@ public:
             ListEntry<T> *current_next = e->next();
 
             e->next(entry);
-            entry.next(current_next);
+            if (current_next != NULL)
+            {
+                entry.next(*current_next);
+            }
+            else
+            {
+                entry.reset_next();
+            }
             m_list_size++;
         }
         else
@@ -162,30 +249,6 @@ public:
         return;
     }
 
-    uint16_t next(ListEntry<T>* entry) 
-    {
-        static uint16_t entry_count = 0;
-        if(m_last_active_entry != NULL && m_last_active_entry->isNext())
-        {
-            m_last_active_entry = m_last_active_entry->next();
-            entry_count++;           
-        }
-        else 
-        {
-            m_last_active_entry = at_index(0);
-            entry_count = 0;
-        }
-        *entry = *m_last_active_entry;
-       
-        return m_last_active_entry;
-    }
-
-    void reset(void) 
-    {
-        m_last_active_entry = at_index(0);
-
-    } 
-
     /**
      * @brief push_back
      * @param entry
@@ -225,6 +288,80 @@ public:
         return entry->data();
     };
 
+    /**
+     * @brief begin
+     * @return iterator to the first entry
+     */
+    iterator begin(void) { return iterator(m_list_data); }
+
+    /**
+     * @brief end
+     * @return iterator past the last entry
+     */
+    iterator end(void) { return iterator(); }
+
+    /**
+     * @brief begin
+     * @return const iterator to the first entry
+     */
+    const_iterator begin(void) const { return const_iterator(m_list_data); }
+
+    /**
+     * @brief end
+     * @return const iterator past the last entry
+     */
+    const_iterator end(void) const { return const_iterator(); }
+
+    /**
+     * @brief cbegin
+     * @return const iterator to the first entry
+     */
+    const_iterator cbegin(void) const { return begin(); }
+
+    /**
+     * @brief cend
+     * @return const iterator past the last entry
+     */
+    const_iterator cend(void) const { return end(); }
+
+    /**
+     * @brief Split the list into consecutive segments.
+     *
+     * Calls fn(first, last) once per segment, where [first, last) covers
+     * about size() / chunks entries. The segments are disjoint and the
+     * iterators share no state, so fn can hand each segment to a worker
+     * thread. The list must not be modified while segments are processed.
+     *
+     * @param chunks number of segments to create
+     * @param fn callable taking (iterator first, iterator last)
+     * @return number of segments passed to fn
+     */
+    template <class Function>
+    uint16_t for_each_chunk(uint16_t chunks, Function fn)
+    {
+        uint16_t count = 0;
+
+        if (chunks > m_list_size)
+        {
+            chunks = m_list_size;
+        }
+
+        iterator first = begin();
+        for (uint16_t c = 0; c < chunks && first != end(); c++)
+        {
+            uint16_t length = m_list_size / chunks + (c < m_list_size % chunks ? 1 : 0);
+            iterator last = first;
+            for (uint16_t i = 0; i < length && last != end(); i++)
+            {
+                ++last;
+            }
+            fn(first, last);
+            first = last;
+            count++;
+        }
+        return count;
+    }
+
     bool exists(ListEntry<T> &entry)
     {
         bool exist = false;
@@ -265,7 +402,6 @@ private:
 
 private:
     ListEntry<T> *m_list_data;
-    ListEntry<T> *m_last_active_entry;
     uint16_t m_list_size;
 
 };
@@ -0,0 +1,427 @@
+#ifndef OBJECT_POOL_H
+#define OBJECT_POOL_H
+
+#include <atomic>
+#include <new>
+#include <stddef.h>
+#include <stdint.h>
+#include <utility>
+
+/**
+ * @brief Size of a cache line, the slab and the free list head start on one.
+ */
+#ifndef FIFO_CACHE_LINE_SIZE
+#define FIFO_CACHE_LINE_SIZE 64
+#endif
+
+/**
+ * @brief Number of indices an ObjectPoolCache holds at most.
+ */
+#ifndef OBJECT_POOL_CACHE_SIZE
+#define OBJECT_POOL_CACHE_SIZE 32
+#endif
+
+template <class T>
+class ObjectPool;
+
+/**
+ * @class ObjectPoolHandle
+ * @brief Owner of one pool object, releases it when destroyed.
+ *
+ * Handles can be moved but not copied. release() gives the object back
+ * early, detach() hands the index over to the caller, e.g. to pass it
+ * through a FiFo<uint16_t>.
+ *
+ * @tparam T The type of the pool objects.
+ */
+template <class T>
+class ObjectPoolHandle
+{
+public:
+    ObjectPoolHandle() : m_pool(NULL), m_index(0) {}
+
+    ObjectPoolHandle(ObjectPool<T> &pool, uint16_t index) : m_pool(&pool), m_index(index) {}
+
+    ObjectPoolHandle(ObjectPoolHandle &&other) : m_pool(other.m_pool), m_index(other.m_index)
+    {
+        other.m_pool = NULL;
+    }
+
+    ObjectPoolHandle &operator=(ObjectPoolHandle &&other)
+    {
+        if (this != &other)
+        {
+            release();
+            m_pool = other.m_pool;
+            m_index = other.m_index;
+            other.m_pool = NULL;
+        }
+        return *this;
+    }
+
+    ObjectPoolHandle(const ObjectPoolHandle &) = delete;
+    ObjectPoolHandle &operator=(const ObjectPoolHandle &) = delete;
+
+    ~ObjectPoolHandle() { release(); }
+
+    /**
+     * @brief Release the object now.
+     */
+    void release(void)
+    {
+        if (m_pool != NULL)
+            m_pool->release(m_index);
+        m_pool = NULL;
+    }
+
+    /**
+     * @brief Give up ownership without releasing the object.
+     *
+     * @return uint16_t The index, the caller has to release it.
+     */
+    uint16_t detach(void)
+    {
+        m_pool = NULL;
+        return m_index;
+    }
+
+    /**
+     * @brief Does the handle own an object.
+     *
+     * @return true if the handle owns an object.
+     */
+    bool valid(void) const { return m_pool != NULL; }
+
+    /**
+     * @brief Get the index of the object.
+     *
+     * @return uint16_t The index, only meaningful if valid().
+     */
+    uint16_t index(void) const { return m_index; }
+
+    T *get(void) const { return m_pool != NULL ? m_pool->get(m_index) : NULL; }
+    T *operator->(void) const { return get(); }
+    T &operator*(void) const { return *get(); }
+
+private:
+    ObjectPool<T> *m_pool; ///< Owning pool, NULL if empty.
+    uint16_t m_index;      ///< Index of the object.
+};
+
+/**
+ * @class ObjectPool
+ * @brief Fixed-capacity pool of T objects in one cache aligned slab.
+ *
+ * The slab is allocated once by the constructor, acquire() and release()
+ * never allocate. An object is identified by its 16 bit slot index, so
+ * queues can carry indices instead of copies of the objects. The free
+ * indices form a lock-free stack: every slot has a next link and the head
+ * word holds the top index and a tag which changes with every update, so a
+ * CAS cannot succeed on a head which was popped and pushed again in the
+ * meantime. take() and give() move a whole chain of indices with a single
+ * CAS, ObjectPoolCache uses them to refill and flush a per thread cache.
+ *
+ * Objects still acquired when the pool is destroyed are not destructed.
+ *
+ * @tparam T The type of objects.
+ */
+template <class T>
+class ObjectPool
+{
+    static_assert(alignof(T) <= FIFO_CACHE_LINE_SIZE, "the slab is aligned to a cache line");
+
+    template <class, uint16_t>
+    friend class ObjectPoolCache;
+
+public:
+    /**
+     * @brief Index returned when the pool is exhausted.
+     */
+    static const uint16_t NONE = 0xFFFF;
+
+    /**
+     * @brief ObjectPool
+     * @param capacity Number of objects, at most 65535.
+     */
+    explicit ObjectPool(uint16_t capacity) : m_capacity(capacity == NONE ? NONE - 1 : capacity)
+    {
+        m_raw = new uint8_t[(size_t)m_capacity * sizeof(T) + FIFO_CACHE_LINE_SIZE];
+        m_slab = (T *)(((uintptr_t)m_raw + FIFO_CACHE_LINE_SIZE - 1) & ~(uintptr_t)(FIFO_CACHE_LINE_SIZE - 1));
+        m_next = new std::atomic<uint16_t>[m_capacity > 0 ? m_capacity : 1];
+        for (uint16_t i = 0; i < m_capacity; i++)
+        {
+            m_next[i].store(i + 1 < m_capacity ? i + 1 : NONE, std::memory_order_relaxed);
+        }
+        m_head.store(pack(0, m_capacity > 0 ? 0 : NONE), std::memory_order_relaxed);
+        m_available.store(m_capacity, std::memory_order_relaxed);
+    }
+
+    ~ObjectPool()
+    {
+        delete[] m_next;
+        delete[] m_raw;
+    }
+
+    ObjectPool(const ObjectPool &) = delete;
+    ObjectPool &operator=(const ObjectPool &) = delete;
+
+    /**
+     * @brief Take a free slot and construct an object in it.
+     *
+     * @param args Constructor arguments of T.
+     * @return uint16_t Index of the object, NONE if the pool is exhausted.
+     */
+    template <class... Args>
+    uint16_t acquire(Args &&...args)
+    {
+        uint16_t index = NONE;
+        if (take(&index, 1) == 1)
+            construct(index, std::forward<Args>(args)...);
+        return index;
+    }
+
+    /**
+     * @brief Acquire an object owned by a handle.
+     *
+     * @param args Constructor arguments of T.
+     * @return ObjectPoolHandle<T> The handle, not valid() if the pool is exhausted.
+     */
+    template <class... Args>
+    ObjectPoolHandle<T> make(Args &&...args)
+    {
+        uint16_t index = acquire(std::forward<Args>(args)...);
+        return index != NONE ? ObjectPoolHandle<T>(*this, index) : ObjectPoolHandle<T>();
+    }
+
+    /**
+     * @brief Destruct an object and free its slot.
+     *
+     * Every acquired index must be released exactly once, by any thread.
+     *
+     * @param index Index returned by acquire().
+     */
+    void release(uint16_t index)
+    {
+        if (index < m_capacity)
+        {
+            destroy(index);
+            give(index, index, 1);
+        }
+    }
+
+    /**
+     * @brief Get an object.
+     *
+     * @param index Index returned by acquire().
+     * @return T* The object, NULL for an invalid index.
+     */
+    T *get(uint16_t index) const { return index < m_capacity ? &m_slab[index] : NULL; }
+
+    /**
+     * @brief Get the index of an object.
+     *
+     * @param object An object of this pool.
+     * @return uint16_t The index, NONE if the object is not in the slab.
+     */
+    uint16_t indexOf(const T *object) const
+    {
+        uint16_t index = NONE;
+        if (object >= m_slab && object < m_slab + m_capacity)
+            index = (uint16_t)(object - m_slab);
+        return index;
+    }
+
+    /**
+     * @brief Get the capacity.
+     *
+     * @return uint16_t The number of objects the pool can hold.
+     */
+    uint16_t capacity(void) const { return m_capacity; }
+
+    /**
+     * @brief Get the number of free slots.
+     *
+     * Slots held by an ObjectPoolCache count as used.
+     *
+     * @return uint16_t The number of free slots, a snapshot while other
+     * threads acquire or release.
+     */
+    uint16_t available(void) const
+    {
+        int32_t count = m_available.load(std::memory_order_relaxed);
+        return count > 0 ? (uint16_t)count : 0;
+    }
+
+private:
+    static uint64_t pack(uint32_t tag, uint16_t index) { return ((uint64_t)tag << 32) | index; }
+    static uint16_t headIndex(uint64_t head) { return (uint16_t)head; }
+    static uint32_t headTag(uint64_t head) { return (uint32_t)(head >> 32); }
+
+    template <class... Args>
+    void construct(uint16_t index, Args &&...args)
+    {
+        new (&m_slab[index]) T(std::forward<Args>(args)...);
+    }
+
+    void destroy(uint16_t index) { m_slab[index].~T(); }
+
+    /**
+     * @brief Pop up to n free indices with one CAS.
+     *
+     * The chain is walked before the CAS; if the tag is unchanged when the
+     * CAS succeeds, no other thread touched the stack meanwhile, so the
+     * walked links were consistent.
+     *
+     * @param out Receives the indices.
+     * @param n Maximum number of indices.
+     * @return uint16_t Number of taken indices.
+     */
+    uint16_t take(uint16_t *out, uint16_t n)
+    {
+        uint64_t head = m_head.load(std::memory_order_acquire);
+        uint16_t count = 0;
+        bool taken = false;
+
+        while (!taken && n > 0 && headIndex(head) != NONE)
+        {
+            uint16_t index = headIndex(head);
+            count = 0;
+            while (count < n && index != NONE)
+            {
+                out[count++] = index;
+                index = m_next[index].load(std::memory_order_relaxed);
+            }
+            taken = m_head.compare_exchange_weak(head, pack(headTag(head) + 1, index),
+                                                 std::memory_order_acquire, std::memory_order_acquire);
+        }
+        if (taken)
+            m_available.fetch_sub(count, std::memory_order_relaxed);
+        return taken ? count : 0;
+    }
+
+    /**
+     * @brief Push a chain of free indices with one CAS.
+     *
+     * @param first First index of the chain.
+     * @param last Last index of the chain, its link is overwritten.
+     * @param n Number of indices in the chain.
+     */
+    void give(uint16_t first, uint16_t last, uint16_t n)
+    {
+        uint64_t head = m_head.load(std::memory_order_relaxed);
+        do
+        {
+            m_next[last].store(headIndex(head), std::memory_order_relaxed);
+        } while (!m_head.compare_exchange_weak(head, pack(headTag(head) + 1, first),
+                                               std::memory_order_release, std::memory_order_relaxed));
+        m_available.fetch_add(n, std::memory_order_relaxed);
+    }
+
+    alignas(FIFO_CACHE_LINE_SIZE) std::atomic<uint64_t> m_head; ///< Tag and top index of the free stack.
+    std::atomic<int32_t> m_available;                           ///< Number of free slots, briefly negative while a release is in flight.
+    T *m_slab;                                                  ///< Cache aligned objects.
+    std::atomic<uint16_t> *m_next;                              ///< Free stack links per slot.
+    uint8_t *m_raw;                                             ///< Allocation holding the slab.
+    uint16_t m_capacity;                                        ///< Number of slots.
+};
+
+// Definition for uses of NONE which bind a reference, e.g. std::max()
+template <class T>
+const uint16_t ObjectPool<T>::NONE;
+
+/**
+ * @class ObjectPoolCache
+ * @brief Per thread cache of free indices in front of an ObjectPool.
+ *
+ * acquire() and release() work on a small local stack without atomics. An
+ * empty cache takes half its size from the pool at once, a full one gives
+ * half of it back, both with a single CAS on the pool. One cache must only
+ * be used by one thread, e.g. as a thread_local or on the stack of a
+ * worker. Indices remaining in the cache are given back by the destructor.
+ *
+ * @tparam T The type of the pool objects.
+ * @tparam Size Number of cached indices, at least 2.
+ */
+template <class T, uint16_t Size = OBJECT_POOL_CACHE_SIZE>
+class ObjectPoolCache
+{
+    static_assert(Size >= 2, "the cache moves half of its size at once");
+
+public:
+    explicit ObjectPoolCache(ObjectPool<T> &pool) : m_pool(pool), m_count(0) {}
+
+    ~ObjectPoolCache() { flush(m_count); }
+
+    ObjectPoolCache(const ObjectPoolCache &) = delete;
+    ObjectPoolCache &operator=(const ObjectPoolCache &) = delete;
+
+    /**
+     * @brief Take a free slot and construct an object in it.
+     *
+     * @param args Constructor arguments of T.
+     * @return uint16_t Index of the object, NONE if the pool is exhausted.
+     */
+    template <class... Args>
+    uint16_t acquire(Args &&...args)
+    {
+        uint16_t index = ObjectPool<T>::NONE;
+        if (m_count == 0)
+            m_count = m_pool.take(m_indices, Size / 2);
+        if (m_count > 0)
+        {
+            index = m_indices[--m_count];
+            m_pool.construct(index, std::forward<Args>(args)...);
+        }
+        return index;
+    }
+
+    /**
+     * @brief Destruct an object and keep its slot in the cache.
+     *
+     * @param index Index of an object of the pool, acquired by any thread.
+     */
+    void release(uint16_t index)
+    {
+        if (index < m_pool.capacity())
+        {
+            m_pool.destroy(index);
+            if (m_count == Size)
+                flush(Size / 2);
+            m_indices[m_count++] = index;
+        }
+    }
+
+    /**
+     * @brief Get the pool.
+     *
+     * @return ObjectPool<T>& The pool behind the cache.
+     */
+    ObjectPool<T> &pool(void) { return m_pool; }
+
+private:
+    /**
+     * @brief Give the n oldest cached indices back to the pool.
+     */
+    void flush(uint16_t n)
+    {
+        if (n > 0)
+        {
+            for (uint16_t i = 0; i + 1 < n; i++)
+            {
+                m_pool.m_next[m_indices[i]].store(m_indices[i + 1], std::memory_order_relaxed);
+            }
+            m_pool.give(m_indices[0], m_indices[n - 1], n);
+            for (uint16_t i = n; i < m_count; i++)
+            {
+                m_indices[i - n] = m_indices[i];
+            }
+            m_count -= n;
+        }
+    }
+
+    ObjectPool<T> &m_pool;     ///< Pool behind the cache.
+    uint16_t m_indices[Size];  ///< Cached free indices, the newest last.
+    uint16_t m_count;          ///< Number of cached indices.
+};
+
+#endif
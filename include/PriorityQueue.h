@@ -0,0 +1,302 @@
+#ifndef PRIORITY_QUEUE_H
+#define PRIORITY_QUEUE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief The PriorityQueueLess class
+ *
+ * Default comparator of the PriorityQueue, the smallest element is read
+ * first.
+ */
+template <class T>
+struct PriorityQueueLess
+{
+    bool operator()(const T &a, const T &b) const { return a < b; }
+};
+
+/**
+ * @brief Heap slot of a PriorityQueue.
+ *
+ * Stable queues store an insertion number next to every element, which
+ * breaks ties between equal elements in write order.
+ */
+template <class T, bool Stable>
+struct PriorityQueueSlot
+{
+    T value;
+};
+
+template <class T>
+struct PriorityQueueSlot<T, true>
+{
+    T value;
+    uint32_t sequence;
+};
+
+/**
+ * @brief Number of bytes a PriorityQueue needs for quantity elements.
+ */
+#define PRIORITY_QUEUE_CALCULATE_BUFFERSIZE(quantity, type, stable)   \
+        ((quantity) * sizeof(PriorityQueueSlot<type, stable>))
+
+/**
+ * @class PriorityQueue
+ * @brief Fixed-capacity priority queue over a caller provided buffer.
+ *
+ * d-ary heap with the FiFo interface: initBuffer() hands over the storage,
+ * write() adds an element, read() removes the element which comes first in
+ * Compare order and dataAvailable() tells if there is one. write() and
+ * read() take O(log n) steps, push_range() adds many elements and rebuilds
+ * the heap in O(n) when that is cheaper than single inserts. A 4-ary heap
+ * needs half the levels of a binary heap and keeps the children of a node
+ * next to each other in memory.
+ *
+ * Without Stable the order of equal elements is unspecified. With Stable
+ * they are read in write order; each slot then carries a 32 bit insertion
+ * number, which is compared when Compare finds two elements equal.
+ *
+ * @tparam T The type of elements.
+ * @tparam Compare Comparator, Compare(a, b) is true if a is read before b.
+ * @tparam Arity Number of children per node, at least 2.
+ * @tparam Stable Keep equal elements in write order.
+ */
+template <class T, class Compare = PriorityQueueLess<T>, uint8_t Arity = 4, bool Stable = false>
+class PriorityQueue
+{
+    static_assert(Arity >= 2, "a heap node needs at least two children");
+
+public:
+    typedef PriorityQueueSlot<T, Stable> Slot;
+
+    /**
+     * @brief PriorityQueue
+     * @param compare comparator instance
+     */
+    explicit PriorityQueue(const Compare &compare = Compare())
+        : m_slots(NULL), m_capacity(0), m_size(0), m_sequence(0), m_compare(compare)
+    {
+    }
+
+    PriorityQueue(const PriorityQueue &) = delete;
+    PriorityQueue &operator=(const PriorityQueue &) = delete;
+
+    /**
+     * @brief Init the queue, like FiFo::initBuffer().
+     *
+     * @param buffer Storage aligned for Slot, see PRIORITY_QUEUE_CALCULATE_BUFFERSIZE.
+     * @param size Size of the storage in bytes.
+     */
+    void initBuffer(uint8_t *buffer, uint16_t size)
+    {
+        m_slots = (Slot *)buffer;
+        m_capacity = buffer != NULL ? size / sizeof(Slot) : 0;
+        m_size = 0;
+        m_sequence = 0;
+    }
+
+    /**
+     * @brief Add an element.
+     *
+     * @param data The element.
+     * @return false if the queue is full or not initialised.
+     */
+    bool write(const T &data)
+    {
+        bool ok = false;
+        if (m_size < m_capacity)
+        {
+            Slot slot;
+            slot.value = data;
+            stamp(slot);
+            siftUp(m_size, slot);
+            m_size++;
+            ok = true;
+        }
+        return ok;
+    }
+
+    /**
+     * @brief Add several elements.
+     *
+     * Elements which do not fit are dropped. If the batch is large compared
+     * to the queue, the elements are appended and the heap is rebuilt
+     * bottom-up instead of inserting them one by one.
+     *
+     * @param data The elements.
+     * @param count Number of elements.
+     * @return uint16_t Number of added elements.
+     */
+    uint16_t push_range(const T *data, uint16_t count)
+    {
+        if (count > m_capacity - m_size)
+            count = m_capacity - m_size;
+
+        // Single inserts cost about count * log(n), rebuilding about 2 * n
+        if (count > 0 && (uint32_t)count * levels(m_size + count) > 2u * (m_size + count))
+        {
+            for (uint16_t i = 0; i < count; i++)
+            {
+                m_slots[m_size + i].value = data[i];
+                stamp(m_slots[m_size + i]);
+            }
+            m_size += count;
+            for (uint16_t i = parent(m_size - 1) + 1; i-- > 0;)
+            {
+                Slot slot = m_slots[i];
+                siftDown(i, slot);
+            }
+        }
+        else
+        {
+            for (uint16_t i = 0; i < count; i++)
+            {
+                write(data[i]);
+            }
+        }
+        return count;
+    }
+
+    /**
+     * @brief Remove the first element.
+     *
+     * @return T The element, T() if the queue is empty.
+     */
+    T read(void)
+    {
+        T data = T();
+        if (m_size > 0)
+        {
+            data = m_slots[0].value;
+            m_size--;
+            if (m_size > 0)
+            {
+                Slot last = m_slots[m_size];
+                siftDown(0, last);
+            }
+        }
+        return data;
+    }
+
+    /**
+     * @brief Get the first element without removing it.
+     *
+     * @return const T& The element, only valid if dataAvailable().
+     */
+    const T &peek(void) const { return m_slots[0].value; }
+
+    /**
+     * @brief Has the queue data to read.
+     *
+     * @return true if the queue is not empty.
+     */
+    bool dataAvailable(void) const { return m_size > 0; }
+
+    /**
+     * @brief Is the queue full.
+     *
+     * @return true if write() would fail.
+     */
+    bool isFull(void) const { return m_size >= m_capacity; }
+
+    /**
+     * @brief Get the number of elements.
+     *
+     * @return uint16_t The number of elements.
+     */
+    uint16_t size(void) const { return m_size; }
+
+    /**
+     * @brief Get the capacity.
+     *
+     * @return uint16_t The number of elements the queue can hold.
+     */
+    uint16_t capacity(void) const { return m_capacity; }
+
+    /**
+     * @brief Remove all elements.
+     */
+    void clear(void) { m_size = 0; }
+
+private:
+    static uint16_t parent(uint16_t i) { return (uint16_t)((i - 1) / Arity); }
+
+    static uint8_t levels(uint32_t n)
+    {
+        uint8_t l = 1;
+        for (uint32_t width = Arity; width < n; width *= Arity)
+        {
+            l++;
+        }
+        return l;
+    }
+
+    void stamp(Slot &slot) { stampSlot(slot, m_sequence); }
+
+    static void stampSlot(PriorityQueueSlot<T, false> &, uint32_t &) {}
+
+    static void stampSlot(PriorityQueueSlot<T, true> &slot, uint32_t &sequence) { slot.sequence = sequence++; }
+
+    bool before(const PriorityQueueSlot<T, false> &a, const PriorityQueueSlot<T, false> &b) const
+    {
+        return m_compare(a.value, b.value);
+    }
+
+    bool before(const PriorityQueueSlot<T, true> &a, const PriorityQueueSlot<T, true> &b) const
+    {
+        return m_compare(a.value, b.value) ||
+               (!m_compare(b.value, a.value) && (int32_t)(a.sequence - b.sequence) < 0);
+    }
+
+    /**
+     * @brief Move slot up from the hole at i to its place.
+     */
+    void siftUp(uint16_t i, const Slot &slot)
+    {
+        while (i > 0)
+        {
+            uint16_t p = parent(i);
+            if (!before(slot, m_slots[p]))
+                break;
+            m_slots[i] = m_slots[p];
+            i = p;
+        }
+        m_slots[i] = slot;
+    }
+
+    /**
+     * @brief Move slot down from the hole at i to its place.
+     */
+    void siftDown(uint16_t i, const Slot &slot)
+    {
+        while (true)
+        {
+            uint32_t first = (uint32_t)i * Arity + 1;
+            if (first >= m_size)
+                break;
+
+            uint32_t last = first + Arity < m_size ? first + Arity : m_size;
+            uint32_t best = first;
+            for (uint32_t c = first + 1; c < last; c++)
+            {
+                if (before(m_slots[c], m_slots[best]))
+                    best = c;
+            }
+            if (!before(m_slots[best], slot))
+                break;
+            m_slots[i] = m_slots[best];
+            i = (uint16_t)best;
+        }
+        m_slots[i] = slot;
+    }
+
+private:
+    Slot *m_slots;         ///< Heap storage.
+    uint16_t m_capacity;   ///< Number of slots.
+    uint16_t m_size;       ///< Number of elements.
+    uint32_t m_sequence;   ///< Insertion number of the next element, stable queues only.
+    Compare m_compare;     ///< Comparator.
+};
+
+#endif
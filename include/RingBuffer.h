@@ -3,6 +3,7 @@
 #define RING_BUFFER_H
 #include <iostream>
 #include <stdio.h>
+#include "BufferStats.h"
 
 /**
  * @enum Direction_e
@@ -27,9 +28,10 @@ enum Direction_e
  * a fixed size.
  *
  * @tparam T The type of elements stored in the buffer.
+ * @tparam Stats Statistics policy, BufferNoStats (default) or BufferStats.
  */
-template <class T>
-class RingBuffer
+template <class T, class Stats = BufferNoStats>
+class RingBuffer : private Stats
 {
 public:
     /**
@@ -43,11 +45,25 @@ public:
                         uint16_t start_index = 0,
                         Direction_e direction = DIR_FORWARD) : m_current_idx(start_index),
                                                                m_buffer_size(size_of_buffer),
-                                                               m_direction(direction)
+                                                               m_direction(direction),
+                                                               m_filled(0)
     {
         m_buffer_data = new T[size_of_buffer];
+        m_occupied = Stats::enabled ? new uint8_t[(size_of_buffer + 7) / 8]() : NULL;
     }
 
+    /**
+     * @brief Destroy the Ring Buffer object and release the buffer data.
+     */
+    ~RingBuffer()
+    {
+        delete[] m_buffer_data;
+        delete[] m_occupied;
+    }
+
+    RingBuffer(const RingBuffer &) = delete;
+    RingBuffer &operator=(const RingBuffer &) = delete;
+
     /**
      * @brief Add an element to the buffer at a specific index (rvalue overload).
      *
@@ -59,6 +75,7 @@ public:
         if (idx < m_buffer_size)
         {
             m_buffer_data[idx] = data;
+            updateStatistics(idx);
         }
     }
 
@@ -73,6 +90,7 @@ public:
         if (idx < m_buffer_size)
         {
             m_buffer_data[idx] = data;
+            updateStatistics(idx);
         }
     }
 
@@ -85,6 +103,7 @@ public:
     void add(T &&data, bool move_next_idx = true)
     {
         m_buffer_data[m_current_idx] = data;
+        updateStatistics(m_current_idx);
         if (move_next_idx)
             moveNext();
     }
@@ -109,6 +128,7 @@ public:
     void add(T &data, bool move_next_idx = true)
     {
         m_buffer_data[m_current_idx] = data;
+        updateStatistics(m_current_idx);
         if (move_next_idx)
             moveNext();
     }
@@ -212,7 +232,32 @@ public:
      * @brief size
      * @return
      */
-    uint16_t size(void) { return m_list_size; }
+    uint16_t size(void) { return m_buffer_size; }
+
+    /**
+     * @brief Get a snapshot of the runtime statistics.
+     *
+     * An add to a slot which already holds an element counts as overwrite,
+     * the fill level is the number of slots written so far. All values are
+     * zero without a statistics policy.
+     *
+     * @return BufferStatistics_t The statistics snapshot.
+     */
+    BufferStatistics_t getStatistics(void)
+    {
+        BufferStatistics_t stats;
+        Stats::snapshot(stats);
+        stats.capacity = m_buffer_size;
+        return stats;
+    }
+
+    /**
+     * @brief Reset the runtime statistics.
+     *
+     * Only the counters are cleared, the slots stay occupied, so writes
+     * into a full buffer still count as overwrites afterwards.
+     */
+    void resetStatistics(void) { Stats::reset(); }
 
 
 private:
@@ -223,10 +268,38 @@ private:
      */
     void setOffset(int16_t offset)
     {
+        uint16_t previous = m_current_idx;
+
         if (m_direction == DIR_FORWARD)
             m_current_idx = calculateIndex(offset);
         else
             m_current_idx = calculateIndex(-1 * offset);
+
+        int16_t step = m_direction == DIR_FORWARD ? offset : -1 * offset;
+        if ((step > 0 && m_current_idx < previous) || (step < 0 && m_current_idx > previous))
+            Stats::wrapped();
+    }
+
+    /**
+     * @brief Record an add to the slot idx in the statistics.
+     */
+    void updateStatistics(uint16_t idx)
+    {
+        if (Stats::enabled)
+        {
+            uint8_t bit = (uint8_t)(1u << (idx % 8));
+
+            if ((m_occupied[idx / 8] & bit) != 0)
+            {
+                Stats::overwritten();
+            }
+            else
+            {
+                m_occupied[idx / 8] |= bit;
+                m_filled++;
+            }
+            Stats::pushed(1, m_filled, m_buffer_size);
+        }
     }
 
     /**
@@ -248,6 +321,8 @@ private:
     uint16_t m_current_idx;  ///< Current index within the buffer.
     uint16_t m_buffer_size;  ///< Total size of the buffer.
     Direction_e m_direction; ///< Current direction of navigation.
+    uint8_t *m_occupied;     ///< Bit per written slot, only with a statistics policy.
+    uint16_t m_filled;       ///< Number of written slots, kept by resetStatistics().
 };
 
 #endif
@@ -0,0 +1,539 @@
+#ifndef SHARED_FIFO_H
+#define SHARED_FIFO_H
+
+/*
+ * Inter-process FiFo in a shared memory segment. Linux only, the header is
+ * empty on other platforms so it can be included unconditionally.
+ */
+#if defined(__linux__)
+
+#include <atomic>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <linux/futex.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <type_traits>
+#include <unistd.h>
+
+#define SHARED_FIFO_MAGIC                0x46494653u
+#define SHARED_FIFO_VERSION              1u
+
+/**
+ * @brief Polls of a waiting side before it sleeps on the futex.
+ */
+#ifndef SHARED_FIFO_SPIN_ROUNDS
+#define SHARED_FIFO_SPIN_ROUNDS          64
+#endif
+
+/**
+ * @brief Shared FiFo Status
+ */
+enum SHARED_FIFO_Status_e
+{
+   SHARED_FIFO_NO_INIT = 0x00,
+   SHARED_FIFO_READY,
+   SHARED_FIFO_CLOSED,
+};
+
+/**
+ * @brief Shared FiFo Header
+ *
+ * Start of the shared segment. It holds no pointers, the data region is
+ * found by its offset from the start of the segment, so every process can
+ * map the segment at a different address. The write side and the read side
+ * each own one cache line.
+ */
+typedef struct
+{
+   uint32_t magic;
+   uint32_t version;
+   uint32_t capacity;
+   uint32_t elementSize;
+   uint32_t dataOffset;
+   std::atomic<uint32_t> status;
+   alignas(64) std::atomic<uint32_t> write;
+   std::atomic<uint32_t> readerWaiting;
+   alignas(64) std::atomic<uint32_t> read;
+   std::atomic<uint32_t> writerWaiting;
+} SHARED_FIFO_Header_t;
+
+/**
+ * @class SharedFiFo
+ * @brief Single producer, single consumer FiFo shared between processes.
+ *
+ * One process create()s the segment, either named with shm_open() or
+ * anonymous with memfd_create(); the other one open()s the name or
+ * attach()es a file descriptor it inherited or received. The indices are
+ * free running 32 bit counters updated with acquire/release atomics, the
+ * capacity is a power of two. write() and read() never block; a side which
+ * has to wait calls waitForData() or waitForSpace(), which poll shortly and
+ * then sleep on a futex in the segment. The other side only makes the wake
+ * system call when the waiting flag of its peer is set.
+ *
+ * @tparam T The type of elements, must be trivially copyable and must not
+ * contain pointers.
+ */
+template <class T>
+class SharedFiFo
+{
+    static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "futex needs plain 32 bit atomics");
+    static_assert(std::is_trivially_copyable<T>::value, "elements are copied as bytes into a segment other processes map");
+
+public:
+    SharedFiFo() : m_header(NULL), m_data(NULL), m_mask(0), m_size(0), m_fd(-1) {}
+
+    ~SharedFiFo() { detach(); }
+
+    SharedFiFo(const SharedFiFo &) = delete;
+    SharedFiFo &operator=(const SharedFiFo &) = delete;
+
+    /**
+     * @brief Get the segment size for a capacity.
+     *
+     * @param capacity Number of elements, a power of two.
+     * @return size_t Size of the segment in bytes.
+     */
+    static size_t segmentSize(uint32_t capacity)
+    {
+        return dataOffset() + (size_t)capacity * sizeof(T);
+    }
+
+    /**
+     * @brief Create and map a new segment.
+     *
+     * @param name Name for shm_open(), e.g. "/acquisition", or NULL for an
+     * anonymous memfd which is shared by passing fd() to the other process.
+     * @param capacity Number of elements, rounded down to a power of two.
+     * @return false if the segment could not be created, see errno.
+     */
+    bool create(const char *name, uint32_t capacity)
+    {
+        uint32_t count = 1;
+        bool ok = false;
+        int fd;
+
+        while (count * 2 <= capacity && count < 0x80000000u)
+        {
+            count *= 2;
+        }
+
+        detach();
+        fd = name != NULL ? shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0600)
+                          : memfd_create("SharedFiFo", MFD_CLOEXEC);
+        if (fd >= 0 && ftruncate(fd, (off_t)segmentSize(count)) == 0 &&
+            map(fd, segmentSize(count)))
+        {
+            m_header->magic = SHARED_FIFO_MAGIC;
+            m_header->version = SHARED_FIFO_VERSION;
+            m_header->capacity = count;
+            m_header->elementSize = sizeof(T);
+            m_header->dataOffset = (uint32_t)dataOffset();
+            m_header->write.store(0, std::memory_order_relaxed);
+            m_header->read.store(0, std::memory_order_relaxed);
+            m_header->readerWaiting.store(0, std::memory_order_relaxed);
+            m_header->writerWaiting.store(0, std::memory_order_relaxed);
+            m_header->status.store(SHARED_FIFO_READY, std::memory_order_release);
+            setLayout();
+            ok = true;
+        }
+        else if (fd >= 0)
+        {
+            int error = errno;
+            ::close(fd);
+            if (name != NULL)
+                shm_unlink(name);
+            errno = error;
+        }
+        return ok;
+    }
+
+    /**
+     * @brief Map a segment created with a name.
+     *
+     * @param name The name passed to create().
+     * @return false if the segment does not exist or does not match T.
+     */
+    bool open(const char *name)
+    {
+        bool ok = false;
+        int fd = shm_open(name, O_RDWR, 0);
+        if (fd >= 0)
+        {
+            ok = attach(fd);
+            ::close(fd);
+        }
+        return ok;
+    }
+
+    /**
+     * @brief Map a segment from a file descriptor.
+     *
+     * @param fd Descriptor of the segment, it is duplicated.
+     * @return false if the segment is not a ready SharedFiFo of T.
+     */
+    bool attach(int fd)
+    {
+        struct stat st;
+        bool ok = false;
+        int own;
+
+        detach();
+        own = fcntl(fd, F_DUPFD_CLOEXEC, 0);
+        if (own >= 0 && fstat(own, &st) == 0 && (size_t)st.st_size >= dataOffset() &&
+            map(own, (size_t)st.st_size))
+        {
+            SHARED_FIFO_Header_t *h = m_header;
+            ok = h->magic == SHARED_FIFO_MAGIC && h->version == SHARED_FIFO_VERSION &&
+                 h->elementSize == sizeof(T) && h->dataOffset == dataOffset() &&
+                 h->capacity > 0 && (h->capacity & (h->capacity - 1)) == 0 &&
+                 segmentSize(h->capacity) <= (size_t)st.st_size &&
+                 h->status.load(std::memory_order_acquire) != SHARED_FIFO_NO_INIT;
+            if (ok)
+                setLayout();
+            else
+                detach();
+            errno = ok ? errno : EINVAL;
+        }
+        else if (own >= 0)
+        {
+            ::close(own);
+        }
+        return ok;
+    }
+
+    /**
+     * @brief Unmap the segment. The segment itself lives on while other
+     * processes have it mapped; a named one until unlink().
+     */
+    void detach(void)
+    {
+        if (m_header != NULL)
+            munmap(m_header, m_size);
+        if (m_fd >= 0)
+            ::close(m_fd);
+        m_header = NULL;
+        m_data = NULL;
+        m_mask = 0;
+        m_size = 0;
+        m_fd = -1;
+    }
+
+    /**
+     * @brief Remove the name of a segment.
+     *
+     * @param name The name passed to create().
+     * @return true if the name was removed.
+     */
+    static bool unlink(const char *name) { return shm_unlink(name) == 0; }
+
+    /**
+     * @brief Get the descriptor of the mapped segment, e.g. to pass it to
+     * a child process.
+     *
+     * @return int The descriptor, -1 if nothing is mapped.
+     */
+    int fd(void) { return m_fd; }
+
+    /**
+     * @brief Write an element. Producer only.
+     *
+     * @param data The element.
+     * @return false if the FiFo is full, closed or not mapped.
+     */
+    bool write(const T &data) { return write(&data, 1) == 1; }
+
+    /**
+     * @brief Write several elements with one index update. Producer only.
+     *
+     * @param data The elements.
+     * @param n Number of elements.
+     * @return uint32_t Number of written elements, 0 once the FiFo is closed.
+     */
+    uint32_t write(const T *data, uint32_t n)
+    {
+        uint32_t done = 0;
+        if (!closed())
+        {
+            uint32_t w = m_header->write.load(std::memory_order_relaxed);
+            uint32_t r = m_header->read.load(std::memory_order_acquire);
+            uint32_t space = m_mask + 1 - (w - r);
+
+            done = n < space ? n : space;
+            if (done > 0)
+            {
+                copyIn(w, data, done);
+                m_header->write.store(w + done, std::memory_order_release);
+                wake(m_header->readerWaiting, m_header->write);
+            }
+        }
+        return done;
+    }
+
+    /**
+     * @brief Read an element. Consumer only.
+     *
+     * @param data Receives the element.
+     * @return false if the FiFo is empty or not mapped.
+     */
+    bool read(T &data) { return read(&data, 1) == 1; }
+
+    /**
+     * @brief Read several elements with one index update. Consumer only.
+     *
+     * @param data Destination with space for n elements.
+     * @param n Maximum number of elements.
+     * @return uint32_t Number of read elements.
+     */
+    uint32_t read(T *data, uint32_t n)
+    {
+        uint32_t done = 0;
+        if (m_header != NULL)
+        {
+            uint32_t r = m_header->read.load(std::memory_order_relaxed);
+            uint32_t w = m_header->write.load(std::memory_order_acquire);
+
+            done = n < w - r ? n : w - r;
+            if (done > 0)
+            {
+                copyOut(r, data, done);
+                m_header->read.store(r + done, std::memory_order_release);
+                wake(m_header->writerWaiting, m_header->read);
+            }
+        }
+        return done;
+    }
+
+    /**
+     * @brief Wait until data is available.
+     *
+     * @param timeoutMs Timeout in milliseconds, negative waits forever.
+     * @return true if data is available, false on timeout or once the
+     * FiFo is closed and empty.
+     */
+    bool waitForData(int32_t timeoutMs = -1)
+    {
+        return m_header != NULL && wait(m_header->readerWaiting, m_header->write, true, timeoutMs);
+    }
+
+    /**
+     * @brief Wait until space is available.
+     *
+     * @param timeoutMs Timeout in milliseconds, negative waits forever.
+     * @return true if space is available, false on timeout or once the
+     * FiFo is closed.
+     */
+    bool waitForSpace(int32_t timeoutMs = -1)
+    {
+        return m_header != NULL && wait(m_header->writerWaiting, m_header->read, false, timeoutMs);
+    }
+
+    /**
+     * @brief Has FIFO Data To Read
+     *
+     * @return true if elements are available.
+     */
+    bool dataAvailable(void) { return getUsedBufferSize() > 0; }
+
+    /**
+     * @brief Get the number of queued elements.
+     *
+     * @return uint32_t Number of elements.
+     */
+    uint32_t getUsedBufferSize(void)
+    {
+        uint32_t used = 0;
+        if (m_header != NULL)
+            used = m_header->write.load(std::memory_order_acquire) -
+                   m_header->read.load(std::memory_order_acquire);
+        return used;
+    }
+
+    /**
+     * @brief Get the number of free elements.
+     *
+     * @return uint32_t Number of elements.
+     */
+    uint32_t getFreeBufferSpace(void) { return getSizeOfBuffer() - getUsedBufferSize(); }
+
+    /**
+     * @brief Get the capacity.
+     *
+     * @return uint32_t Number of elements the FiFo can hold.
+     */
+    uint32_t getSizeOfBuffer(void) { return m_header != NULL ? m_mask + 1 : 0; }
+
+    /**
+     * @brief Close the FiFo for both sides and wake the waiting side.
+     *
+     * Further writes are rejected, queued elements can still be read.
+     */
+    void close(void)
+    {
+        if (m_header != NULL)
+        {
+            m_header->status.store(SHARED_FIFO_CLOSED, std::memory_order_seq_cst);
+            futex(m_header->write, FUTEX_WAKE, INT_MAX, NULL);
+            futex(m_header->read, FUTEX_WAKE, INT_MAX, NULL);
+        }
+    }
+
+    /**
+     * @brief Check if the FiFo was closed by either side.
+     *
+     * @return true after close(), or if nothing is mapped.
+     */
+    bool closed(void)
+    {
+        return m_header == NULL || m_header->status.load(std::memory_order_acquire) == SHARED_FIFO_CLOSED;
+    }
+
+private:
+    static size_t dataOffset(void)
+    {
+        size_t align = alignof(T) > 64 ? alignof(T) : 64;
+        return (sizeof(SHARED_FIFO_Header_t) + align - 1) / align * align;
+    }
+
+    bool map(int fd, size_t size)
+    {
+        void *p = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        bool ok = p != MAP_FAILED;
+        if (ok)
+        {
+            m_header = (SHARED_FIFO_Header_t *)p;
+            m_size = size;
+            m_fd = fd;
+        }
+        return ok;
+    }
+
+    void setLayout(void)
+    {
+        m_data = (uint8_t *)m_header + m_header->dataOffset;
+        m_mask = m_header->capacity - 1;
+    }
+
+    void copyIn(uint32_t w, const T *data, uint32_t n)
+    {
+        uint32_t index = w & m_mask;
+        uint32_t first = m_mask + 1 - index < n ? m_mask + 1 - index : n;
+        memcpy(m_data + (size_t)index * sizeof(T), data, (size_t)first * sizeof(T));
+        memcpy(m_data, data + first, (size_t)(n - first) * sizeof(T));
+    }
+
+    void copyOut(uint32_t r, T *data, uint32_t n)
+    {
+        uint32_t index = r & m_mask;
+        uint32_t first = m_mask + 1 - index < n ? m_mask + 1 - index : n;
+        memcpy(data, m_data + (size_t)index * sizeof(T), (size_t)first * sizeof(T));
+        memcpy(data + first, m_data, (size_t)(n - first) * sizeof(T));
+    }
+
+    static long futex(std::atomic<uint32_t> &word, int op, int value, const struct timespec *timeout)
+    {
+        return syscall(SYS_futex, (uint32_t *)&word, op, value, timeout, NULL, 0);
+    }
+
+    /**
+     * @brief Wake the peer if it announced that it sleeps on word.
+     */
+    static void wake(std::atomic<uint32_t> &waiting, std::atomic<uint32_t> &word)
+    {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (waiting.load(std::memory_order_relaxed) != 0)
+        {
+            waiting.store(0, std::memory_order_relaxed);
+            futex(word, FUTEX_WAKE, INT_MAX, NULL);
+        }
+    }
+
+    static int64_t monotonicNs(void)
+    {
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        return (int64_t)now.tv_sec * 1000000000 + now.tv_nsec;
+    }
+
+    /**
+     * @brief Check the wait condition: queued data for the consumer, which
+     * may still be read after close(), free space in an open FiFo for the
+     * producer, since write() rejects everything once it is closed.
+     */
+    bool isReady(bool forData)
+    {
+        return forData ? getUsedBufferSize() > 0 : getFreeBufferSpace() > 0 && !closed();
+    }
+
+    /**
+     * @brief Wait until the peer moves word past the own index.
+     *
+     * The timeout is a deadline on CLOCK_MONOTONIC, the clock FUTEX_WAIT
+     * measures its relative timeout with; every sleep only gets the time
+     * left, so wake-ups without progress do not extend the wait.
+     *
+     * @param waiting The waiting flag of this side.
+     * @param word The index written by the peer.
+     * @param forData true for the consumer, false for the producer.
+     * @param timeoutMs Timeout in milliseconds, negative waits forever.
+     */
+    bool wait(std::atomic<uint32_t> &waiting, std::atomic<uint32_t> &word, bool forData, int32_t timeoutMs)
+    {
+        struct timespec timeout;
+        int64_t deadline = timeoutMs >= 0 ? monotonicNs() + (int64_t)timeoutMs * 1000000 : 0;
+        uint32_t round = 0;
+        bool ready = false;
+
+        while (m_header != NULL)
+        {
+            uint32_t seen = word.load(std::memory_order_acquire);
+            ready = isReady(forData);
+            if (ready || closed())
+                break;
+
+            if (round < SHARED_FIFO_SPIN_ROUNDS)
+            {
+                round++;
+                continue;
+            }
+
+            if (timeoutMs >= 0)
+            {
+                int64_t left = deadline - monotonicNs();
+                if (left <= 0)
+                    break;
+                timeout.tv_sec = (time_t)(left / 1000000000);
+                timeout.tv_nsec = (long)(left % 1000000000);
+            }
+
+            waiting.store(1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (word.load(std::memory_order_relaxed) == seen && !closed())
+            {
+                if (futex(word, FUTEX_WAIT, (int)seen, timeoutMs >= 0 ? &timeout : NULL) != 0 &&
+                    errno == ETIMEDOUT)
+                {
+                    ready = isReady(forData);
+                    break;
+                }
+            }
+        }
+        return ready;
+    }
+
+    SHARED_FIFO_Header_t *m_header; ///< Start of the mapped segment.
+    uint8_t *m_data;                ///< Data region in this process.
+    uint32_t m_mask;                ///< Capacity - 1.
+    size_t m_size;                  ///< Size of the mapping.
+    int m_fd;                       ///< Descriptor of the segment.
+};
+
+#endif
+
+#endif
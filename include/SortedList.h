@@ -0,0 +1,432 @@
+#ifndef SORTED_LIST_H
+#define SORTED_LIST_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "LinkedList.h"
+
+/**
+ * @brief Default number of skip list levels.
+ *
+ * With a level probability of 1/4, 12 levels keep the expected search cost
+ * logarithmic up to roughly 16 million entries.
+ */
+#ifndef SORTED_LIST_MAX_LEVEL
+#define SORTED_LIST_MAX_LEVEL 12
+#endif
+
+/**
+ * @brief The SortedListLess class
+ *
+ * Default comparator of the SortedList, orders the entries with operator<.
+ */
+template <class T>
+struct SortedListLess
+{
+    bool operator()(const T &a, const T &b) const { return a < b; }
+};
+
+/**
+ * @brief The SortedListEntry class
+ *
+ * ListEntry extended by the forward pointers of the skip list levels above
+ * level 0. Level 0 is the plain ListEntry chain, so the entries of a
+ * SortedList can be walked with next() like the entries of a LinkedList.
+ */
+template <class T, uint8_t MaxLevel = SORTED_LIST_MAX_LEVEL>
+class SortedListEntry : public ListEntry<T>
+{
+public:
+    SortedListEntry() : ListEntry<T>(), m_level(1)
+    {
+        for (uint8_t i = 0; i < MaxLevel - 1; i++)
+        {
+            m_forward[i] = NULL;
+        }
+    }
+
+    /**
+     * @brief next
+     * @return next entry on level 0
+     */
+    SortedListEntry<T, MaxLevel> *next(void)
+    {
+        return static_cast<SortedListEntry<T, MaxLevel> *>(ListEntry<T>::next());
+    }
+
+    /**
+     * @brief forward
+     * @param level
+     * @return next entry on the given level
+     */
+    SortedListEntry<T, MaxLevel> *forward(uint8_t level)
+    {
+        return level == 0 ? next() : m_forward[level - 1];
+    }
+
+    /**
+     * @brief forward
+     * @param level
+     * @param entry next entry on the given level, NULL to terminate the level
+     */
+    void forward(uint8_t level, SortedListEntry<T, MaxLevel> *entry)
+    {
+        if (level > 0)
+        {
+            m_forward[level - 1] = entry;
+        }
+        else if (entry != NULL)
+        {
+            ListEntry<T>::next(*entry);
+        }
+        else
+        {
+            ListEntry<T>::reset_next();
+        }
+    }
+
+    /**
+     * @brief level
+     * @return number of levels the entry is linked into
+     */
+    uint8_t level(void) { return m_level; }
+
+    /**
+     * @brief level
+     * @param level
+     */
+    void level(uint8_t level) { m_level = level; }
+
+private:
+    SortedListEntry<T, MaxLevel> *m_forward[MaxLevel - 1];
+    uint8_t m_level;
+};
+
+/**
+ * @brief The SortedList class
+ *
+ * Ordered container with probabilistic skip list levels on top of the
+ * ListEntry chain. insert_sorted(), find(), lower_bound() and erase() run in
+ * O(log n) expected time. Entries are taken from a caller provided pool (see
+ * initBuffer()), so inserting never allocates memory.
+ *
+ * @tparam T The type of elements stored in the list.
+ * @tparam Compare Strict weak ordering, defaults to operator<.
+ * @tparam MaxLevel Maximum number of levels of an entry.
+ */
+template <class T, class Compare = SortedListLess<T>, uint8_t MaxLevel = SORTED_LIST_MAX_LEVEL>
+class SortedList
+{
+public:
+    typedef SortedListEntry<T, MaxLevel> Entry;
+
+    /**
+     * @brief SortedList
+     * @param compare comparator instance
+     * @param seed seed of the level generator, must not be 0
+     */
+    explicit SortedList(Compare compare = Compare(), uint32_t seed = 0x9E3779B9u)
+        : m_head(), m_free(NULL), m_compare(compare), m_list_size(0),
+          m_level(1), m_seed(seed != 0 ? seed : 0x9E3779B9u)
+    {
+        m_head.level(MaxLevel);
+    }
+
+    /**
+     * @brief Hand over the entry pool to the list.
+     *
+     * Any previous content of the list is dropped.
+     *
+     * @param pool array of entries used as node storage
+     * @param count number of entries in pool
+     */
+    void initBuffer(Entry *pool, uint32_t count)
+    {
+        m_free = NULL;
+        for (uint32_t i = count; i > 0; i--)
+        {
+            release(&pool[i - 1]);
+        }
+        resetHead();
+    }
+
+    /**
+     * @brief insert_sorted
+     *
+     * Equal entries keep their insertion order.
+     *
+     * @param data
+     * @return the new entry, NULL if the pool is exhausted
+     */
+    Entry *insert_sorted(T data)
+    {
+        Entry *update[MaxLevel];
+        Entry *entry = m_free;
+
+        if (entry != NULL)
+        {
+            m_free = entry->next();
+
+            Entry *e = &m_head;
+            for (int8_t l = m_level - 1; l >= 0; l--)
+            {
+                while (e->forward(l) != NULL && !m_compare(data, *e->forward(l)->data()))
+                {
+                    e = e->forward(l);
+                }
+                update[l] = e;
+            }
+
+            uint8_t level = randomLevel();
+            if (level > m_level)
+            {
+                for (uint8_t l = m_level; l < level; l++)
+                {
+                    update[l] = &m_head;
+                }
+                m_level = level;
+            }
+
+            entry->data(data);
+            entry->level(level);
+            for (uint8_t l = 0; l < level; l++)
+            {
+                entry->forward(l, update[l]->forward(l));
+                update[l]->forward(l, entry);
+            }
+            m_list_size++;
+        }
+        return entry;
+    }
+
+    /**
+     * @brief lower_bound
+     * @param key
+     * @return first entry which is not less than key, NULL if there is none
+     */
+    Entry *lower_bound(const T &key)
+    {
+        return predecessor(key)->next();
+    }
+
+    /**
+     * @brief upper_bound
+     * @param key
+     * @return first entry which is greater than key, NULL if there is none
+     */
+    Entry *upper_bound(const T &key)
+    {
+        Entry *e = &m_head;
+        for (int8_t l = m_level - 1; l >= 0; l--)
+        {
+            while (e->forward(l) != NULL && !m_compare(key, *e->forward(l)->data()))
+            {
+                e = e->forward(l);
+            }
+        }
+        return e->next();
+    }
+
+    /**
+     * @brief find
+     * @param key
+     * @return first entry equal to key, NULL if there is none
+     */
+    Entry *find(const T &key)
+    {
+        Entry *e = lower_bound(key);
+        if (e != NULL && m_compare(key, *e->data()))
+        {
+            e = NULL;
+        }
+        return e;
+    }
+
+    /**
+     * @brief Visit all entries in the range [from, to).
+     *
+     * @param from lower bound of the range, inclusive
+     * @param to upper bound of the range, exclusive
+     * @param visitor callable invoked with T& for each entry in order
+     * @return number of visited entries
+     */
+    template <class Visitor>
+    uint32_t scan(const T &from, const T &to, Visitor visitor)
+    {
+        uint32_t count = 0;
+        for (Entry *e = lower_bound(from); e != NULL && m_compare(*e->data(), to); e = e->next())
+        {
+            visitor(*e->data());
+            count++;
+        }
+        return count;
+    }
+
+    /**
+     * @brief erase
+     *
+     * Removes the first entry equal to key and returns it to the pool.
+     *
+     * @param key
+     * @return true if an entry was removed
+     */
+    bool erase(const T &key)
+    {
+        Entry *update[MaxLevel];
+        Entry *e = &m_head;
+        bool erased = false;
+
+        for (int8_t l = m_level - 1; l >= 0; l--)
+        {
+            while (e->forward(l) != NULL && m_compare(*e->forward(l)->data(), key))
+            {
+                e = e->forward(l);
+            }
+            update[l] = e;
+        }
+
+        e = e->next();
+        if (e != NULL && !m_compare(key, *e->data()))
+        {
+            unlink(e, update);
+            erased = true;
+        }
+        return erased;
+    }
+
+    /**
+     * @brief front
+     * @return smallest entry, NULL if the list is empty
+     */
+    Entry *front(void) { return m_head.next(); }
+
+    /**
+     * @brief pop_front
+     *
+     * Removes the smallest entry and returns it to the pool.
+     */
+    void pop_front(void)
+    {
+        Entry *e = m_head.next();
+        if (e != NULL)
+        {
+            Entry *update[MaxLevel];
+            for (uint8_t l = 0; l < MaxLevel; l++)
+            {
+                update[l] = &m_head;
+            }
+            unlink(e, update);
+        }
+        return;
+    }
+
+    /**
+     * @brief clear
+     *
+     * Returns all entries to the pool.
+     */
+    void clear(void)
+    {
+        Entry *e = m_head.next();
+        while (e != NULL)
+        {
+            Entry *n = e->next();
+            release(e);
+            e = n;
+        }
+        resetHead();
+        return;
+    }
+
+    /**
+     * @brief size
+     * @return
+     */
+    uint32_t size(void) { return m_list_size; }
+
+    /**
+     * @brief empty
+     * @return
+     */
+    bool empty(void) { return m_list_size == 0; }
+
+private:
+    Entry *predecessor(const T &key)
+    {
+        Entry *e = &m_head;
+        for (int8_t l = m_level - 1; l >= 0; l--)
+        {
+            while (e->forward(l) != NULL && m_compare(*e->forward(l)->data(), key))
+            {
+                e = e->forward(l);
+            }
+        }
+        return e;
+    }
+
+    void unlink(Entry *entry, Entry **update)
+    {
+        for (uint8_t l = 0; l < entry->level(); l++)
+        {
+            update[l]->forward(l, entry->forward(l));
+        }
+        while (m_level > 1 && m_head.forward(m_level - 1) == NULL)
+        {
+            m_level--;
+        }
+        release(entry);
+        m_list_size--;
+    }
+
+    void release(Entry *entry)
+    {
+        for (uint8_t l = 1; l < MaxLevel; l++)
+        {
+            entry->forward(l, NULL);
+        }
+        entry->level(1);
+        entry->forward(0, m_free);
+        m_free = entry;
+    }
+
+    void resetHead(void)
+    {
+        for (uint8_t l = 0; l < MaxLevel; l++)
+        {
+            m_head.forward(l, NULL);
+        }
+        m_list_size = 0;
+        m_level = 1;
+    }
+
+    /**
+     * @brief Draw a level with probability 1/4 per additional level.
+     */
+    uint8_t randomLevel(void)
+    {
+        uint8_t level = 1;
+
+        // xorshift32
+        m_seed ^= m_seed << 13;
+        m_seed ^= m_seed >> 17;
+        m_seed ^= m_seed << 5;
+
+        uint32_t bits = m_seed;
+        while (level < MaxLevel && (bits & 0x3u) == 0)
+        {
+            level++;
+            bits >>= 2;
+        }
+        return level;
+    }
+
+private:
+    Entry m_head;
+    Entry *m_free;
+    Compare m_compare;
+    uint32_t m_list_size;
+    uint8_t m_level;
+    uint32_t m_seed;
+};
+
+#endif
@@ -0,0 +1,289 @@
+#ifndef TIMED_RING_BUFFER_H
+#define TIMED_RING_BUFFER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Contiguous run of samples in a TimedRingBuffer.
+ */
+template <class T, class Key>
+struct TimedRingSpan
+{
+    const Key *keys;  ///< Keys of the run, NULL if empty.
+    const T *values;  ///< Values of the run, NULL if empty.
+    uint16_t count;   ///< Number of samples.
+};
+
+/**
+ * @brief Result of a range query, the older samples come first.
+ *
+ * A range which wraps around the end of the storage is split into two
+ * spans, otherwise second is empty.
+ */
+template <class T, class Key>
+struct TimedRingRange
+{
+    TimedRingSpan<T, Key> first;
+    TimedRingSpan<T, Key> second;
+
+    /**
+     * @brief Get the number of samples in both spans.
+     *
+     * @return uint16_t The number of samples.
+     */
+    uint16_t size(void) const { return (uint16_t)(first.count + second.count); }
+};
+
+/**
+ * @class TimedRingBuffer
+ * @brief History ring of samples with non-decreasing keys, e.g. timestamps.
+ *
+ * add() appends a sample and overwrites the oldest one when the buffer is
+ * full; a key older than the newest stored key is rejected, so the stored
+ * keys are always sorted. Keys and values live in two parallel arrays, the
+ * binary searches only touch the key array. The logical sequence occupies
+ * at most two physical segments of the arrays: range() returns the matching
+ * samples as up to two spans pointing into the storage and latest_before()
+ * a pointer to the sample, nothing is copied. The pointers stay valid until
+ * the samples are overwritten.
+ *
+ * Offsets follow RingBuffer::at(): at(-1) is the newest sample.
+ *
+ * @tparam T The type of values.
+ * @tparam Key The type of keys, ordered by operator<.
+ */
+template <class T, class Key = uint64_t>
+class TimedRingBuffer
+{
+public:
+    typedef TimedRingSpan<T, Key> Span;
+    typedef TimedRingRange<T, Key> Range;
+
+    /**
+     * @brief Construct a new Timed Ring Buffer object.
+     *
+     * @param size_of_buffer Number of samples the buffer holds.
+     */
+    explicit TimedRingBuffer(uint16_t size_of_buffer) : m_size(size_of_buffer > 0 ? size_of_buffer : 1)
+    {
+        m_keys = new Key[m_size];
+        m_values = new T[m_size];
+        clear();
+    }
+
+    /**
+     * @brief Destroy the Timed Ring Buffer object and release the storage.
+     */
+    ~TimedRingBuffer()
+    {
+        delete[] m_keys;
+        delete[] m_values;
+    }
+
+    TimedRingBuffer(const TimedRingBuffer &) = delete;
+    TimedRingBuffer &operator=(const TimedRingBuffer &) = delete;
+
+    /**
+     * @brief Remove all samples.
+     */
+    void clear(void)
+    {
+        m_head = 0;
+        m_length = 0;
+    }
+
+    /**
+     * @brief Append a sample, overwriting the oldest one if the buffer is full.
+     *
+     * @param key Key of the sample, not older than the newest key.
+     * @param value The sample.
+     * @return false if key is older than the newest key, nothing is stored.
+     */
+    bool add(const Key &key, const T &value)
+    {
+        bool ok = m_length == 0 || !(key < m_keys[physical(m_length - 1)]);
+        if (ok)
+        {
+            uint16_t idx;
+            if (m_length < m_size)
+            {
+                idx = physical(m_length);
+                m_length++;
+            }
+            else
+            {
+                idx = m_head;
+                m_head = (uint16_t)(m_head + 1 < m_size ? m_head + 1 : 0);
+            }
+            m_keys[idx] = key;
+            m_values[idx] = value;
+        }
+        return ok;
+    }
+
+    /**
+     * @brief Get the samples with from <= key <= to.
+     *
+     * @param from Oldest key of the range.
+     * @param to Newest key of the range.
+     * @return Range The samples in up to two spans, empty if none match.
+     */
+    Range range(const Key &from, const Key &to) const
+    {
+        uint16_t lo = lowerBound(from);
+        uint16_t hi = upperBound(to);
+        return spans(lo, hi > lo ? hi : lo);
+    }
+
+    /**
+     * @brief Get the newest sample with key <= t.
+     *
+     * @param t The key.
+     * @param key Receives the key of the sample if not NULL.
+     * @return const T* The sample, NULL if all samples are newer than t.
+     */
+    const T *latest_before(const Key &t, Key *key = NULL) const
+    {
+        const T *value = NULL;
+        uint16_t hi = upperBound(t);
+        if (hi > 0)
+        {
+            uint16_t idx = physical((uint16_t)(hi - 1));
+            value = &m_values[idx];
+            if (key != NULL)
+                *key = m_keys[idx];
+        }
+        return value;
+    }
+
+    /**
+     * @brief Access the sample at an offset from the newest one.
+     *
+     * @param offset -1 for the newest sample, -length() for the oldest.
+     * @return T& The sample, the oldest one if offset is out of range.
+     */
+    T &at(int16_t offset) { return m_values[physical(logical(offset))]; }
+
+    /**
+     * @brief Get the key of the sample at an offset from the newest one.
+     *
+     * @param offset -1 for the newest sample, -length() for the oldest.
+     * @return const Key& The key, the oldest one if offset is out of range.
+     */
+    const Key &keyAt(int16_t offset) const { return m_keys[physical(logical(offset))]; }
+
+    /**
+     * @brief Get the newest sample.
+     *
+     * @return T& The sample, only valid if length() > 0.
+     */
+    T &current(void) { return at(-1); }
+
+    /**
+     * @brief Get the number of stored samples.
+     *
+     * @return uint16_t The number of samples.
+     */
+    uint16_t length(void) const { return m_length; }
+
+    /**
+     * @brief Get the capacity.
+     *
+     * @return uint16_t The number of samples the buffer holds.
+     */
+    uint16_t size(void) const { return m_size; }
+
+private:
+    uint16_t physical(uint16_t logical) const
+    {
+        uint32_t idx = (uint32_t)m_head + logical;
+        return (uint16_t)(idx < m_size ? idx : idx - m_size);
+    }
+
+    uint16_t logical(int16_t offset) const
+    {
+        int32_t idx = (int32_t)m_length + offset;
+        return (uint16_t)(idx >= 0 && idx < (int32_t)m_length ? idx : 0);
+    }
+
+    /**
+     * @brief First logical index with key >= t, length() if none.
+     */
+    uint16_t lowerBound(const Key &t) const
+    {
+        uint16_t lo = 0;
+        uint16_t count = m_length;
+        while (count > 0)
+        {
+            uint16_t half = count / 2;
+            if (m_keys[physical((uint16_t)(lo + half))] < t)
+            {
+                lo = (uint16_t)(lo + half + 1);
+                count = (uint16_t)(count - half - 1);
+            }
+            else
+            {
+                count = half;
+            }
+        }
+        return lo;
+    }
+
+    /**
+     * @brief First logical index with key > t, length() if none.
+     */
+    uint16_t upperBound(const Key &t) const
+    {
+        uint16_t lo = 0;
+        uint16_t count = m_length;
+        while (count > 0)
+        {
+            uint16_t half = count / 2;
+            if (!(t < m_keys[physical((uint16_t)(lo + half))]))
+            {
+                lo = (uint16_t)(lo + half + 1);
+                count = (uint16_t)(count - half - 1);
+            }
+            else
+            {
+                count = half;
+            }
+        }
+        return lo;
+    }
+
+    /**
+     * @brief Split the logical range [lo, hi) at the end of the storage.
+     */
+    Range spans(uint16_t lo, uint16_t hi) const
+    {
+        Range result = {{NULL, NULL, 0}, {NULL, NULL, 0}};
+        if (hi > lo)
+        {
+            uint16_t start = physical(lo);
+            uint16_t first = (uint16_t)(m_size - start);
+            if (first > hi - lo)
+                first = (uint16_t)(hi - lo);
+            result.first.keys = &m_keys[start];
+            result.first.values = &m_values[start];
+            result.first.count = first;
+            if (first < hi - lo)
+            {
+                result.second.keys = &m_keys[0];
+                result.second.values = &m_values[0];
+                result.second.count = (uint16_t)(hi - lo - first);
+            }
+        }
+        return result;
+    }
+
+private:
+    Key *m_keys;       ///< Keys, parallel to m_values.
+    T *m_values;       ///< Values.
+    uint16_t m_size;   ///< Capacity.
+    uint16_t m_head;   ///< Physical index of the oldest sample.
+    uint16_t m_length; ///< Number of stored samples.
+};
+
+#endif
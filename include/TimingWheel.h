@@ -0,0 +1,352 @@
+#ifndef TIMING_WHEEL_H
+#define TIMING_WHEEL_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "RingBuffer.h"
+
+template <class T, uint8_t Levels, uint8_t SlotBits>
+class TimingWheel;
+
+/**
+ * @brief The TimerEntry class
+ *
+ * Intrusive timer of a TimingWheel, like ListEntry it carries the user data.
+ * The entry is linked into the wheel while it is scheduled, so it must stay
+ * at its address until it fired or was cancelled.
+ */
+template <class T>
+class TimerEntry
+{
+public:
+    TimerEntry() : m_next(NULL), m_pprev(NULL), m_expires(0) {}
+    explicit TimerEntry(T data) : m_data(data), m_next(NULL), m_pprev(NULL), m_expires(0) {}
+
+    TimerEntry(const TimerEntry &) = delete;
+    TimerEntry &operator=(const TimerEntry &) = delete;
+
+    /**
+     * @brief data
+     * @param data
+     */
+    void data(const T &data) { m_data = data; }
+
+    /**
+     * @brief data
+     * @return
+     */
+    T *data(void) { return &m_data; }
+
+    /**
+     * @brief Is the timer linked into a wheel.
+     *
+     * @return true between schedule() and firing or cancel().
+     */
+    bool scheduled(void) const { return m_pprev != NULL; }
+
+    /**
+     * @brief Get the expiry tick.
+     *
+     * @return uint64_t The tick passed to the last schedule().
+     */
+    uint64_t expires(void) const { return m_expires; }
+
+private:
+    template <class, uint8_t, uint8_t>
+    friend class TimingWheel;
+
+    T m_data;
+    TimerEntry<T> *m_next;   ///< Next timer in the slot.
+    TimerEntry<T> **m_pprev; ///< Link pointing at this timer, NULL if not scheduled.
+    uint64_t m_expires;      ///< Expiry tick.
+};
+
+/**
+ * @class TimingWheel
+ * @brief Hierarchical timing wheel over intrusive timer lists.
+ *
+ * Every level is a RingBuffer of 2^SlotBits slots, a slot is the head of a
+ * list of TimerEntry objects. A level 0 slot spans one tick, a slot on level
+ * l spans 2^(SlotBits * l) ticks. The current() slot of each RingBuffer is
+ * the slot of the current tick on that level. schedule() and cancel() take
+ * constant time. advance() walks the level 0 cursor tick by tick; when it
+ * wraps, the next slot of the level above is cascaded, i.e. its timers are
+ * spread over the lower levels. Timers beyond the range of the top level
+ * are parked in its last slot and placed again when it is cascaded.
+ *
+ * Ticks are in the unit of the caller, e.g. milliseconds.
+ *
+ * @tparam T The type of the user data in every TimerEntry.
+ * @tparam Levels Number of levels.
+ * @tparam SlotBits log2 of the number of slots per level, at most 14.
+ */
+template <class T, uint8_t Levels = 4, uint8_t SlotBits = 8>
+class TimingWheel
+{
+    static_assert(Levels >= 1 && SlotBits >= 1 && SlotBits <= 14, "RingBuffer holds up to 2^14 slots here");
+    static_assert((uint32_t)Levels * SlotBits < 64, "the wheel range must fit into 64 bit ticks");
+
+public:
+    typedef TimerEntry<T> Entry;
+
+    /**
+     * @brief TimingWheel
+     * @param now tick the wheel starts at
+     */
+    explicit TimingWheel(uint64_t now = 0) : m_now(now), m_count(0), m_expired(NULL)
+    {
+        for (uint8_t l = 0; l < Levels; l++)
+        {
+            m_levels[l] = new RingBuffer<Entry *>(SLOTS);
+            for (uint16_t s = 0; s < SLOTS; s++)
+            {
+                m_levels[l]->atIndex(s) = NULL;
+            }
+        }
+        syncCursors();
+    }
+
+    /**
+     * @brief Destroy the wheel, all timers are unlinked first.
+     */
+    ~TimingWheel()
+    {
+        clear();
+        for (uint8_t l = 0; l < Levels; l++)
+        {
+            delete m_levels[l];
+        }
+    }
+
+    TimingWheel(const TimingWheel &) = delete;
+    TimingWheel &operator=(const TimingWheel &) = delete;
+
+    /**
+     * @brief Schedule or reschedule a timer.
+     *
+     * A timer which expires at or before the current tick fires on the next
+     * advance() to a later tick.
+     *
+     * @param timer The timer, it is cancelled first if it is scheduled.
+     * @param expires Tick the timer fires at.
+     */
+    void schedule(Entry &timer, uint64_t expires)
+    {
+        cancel(timer);
+        timer.m_expires = expires;
+        place(timer, m_now + 1);
+        m_count++;
+    }
+
+    /**
+     * @brief Cancel a timer.
+     *
+     * @param timer The timer.
+     * @return true if the timer was scheduled.
+     */
+    bool cancel(Entry &timer)
+    {
+        bool linked = timer.scheduled();
+        if (linked)
+        {
+            unlink(timer);
+            m_count--;
+        }
+        return linked;
+    }
+
+    /**
+     * @brief Move the wheel to now and fire all expired timers.
+     *
+     * The timers of a level 0 slot are taken off the wheel at once and
+     * fired as one batch, tick by tick. fire may schedule and cancel any timer,
+     * including the fired one; a timer scheduled for a past tick fires on the
+     * next call.
+     *
+     * @param now The current tick, earlier ticks are ignored.
+     * @param fire Callable taking Entry&, called for every expired timer.
+     * @return uint32_t Number of fired timers.
+     */
+    template <class Fire>
+    uint32_t advance(uint64_t now, Fire fire)
+    {
+        uint32_t fired = 0;
+
+        if (m_count == 0 && now > m_now)
+        {
+            m_now = now;
+            syncCursors();
+        }
+
+        while (m_now < now)
+        {
+            m_now++;
+            m_levels[0]->moveNext();
+            if (m_levels[0]->currentIdx() == 0)
+                cascade();
+
+            Entry *&slot = m_levels[0]->current();
+            if (slot != NULL)
+            {
+                // Move the whole slot to the expired list, fire can then unlink any timer of it
+                m_expired = slot;
+                m_expired->m_pprev = &m_expired;
+                slot = NULL;
+                while (m_expired != NULL)
+                {
+                    Entry &timer = *m_expired;
+                    unlink(timer);
+                    if (timer.m_expires > m_now)
+                    {
+                        place(timer, m_now + 1);
+                    }
+                    else
+                    {
+                        m_count--;
+                        fired++;
+                        fire(timer);
+                    }
+                }
+            }
+        }
+        return fired;
+    }
+
+    /**
+     * @brief Cancel all timers.
+     */
+    void clear(void)
+    {
+        for (uint8_t l = 0; l < Levels; l++)
+        {
+            for (uint16_t s = 0; s < SLOTS; s++)
+            {
+                Entry *&slot = m_levels[l]->atIndex(s);
+                while (slot != NULL)
+                {
+                    unlink(*slot);
+                }
+            }
+        }
+        m_count = 0;
+    }
+
+    /**
+     * @brief Get the current tick.
+     *
+     * @return uint64_t The tick of the last advance().
+     */
+    uint64_t now(void) const { return m_now; }
+
+    /**
+     * @brief Get the number of scheduled timers.
+     *
+     * @return uint32_t The number of timers.
+     */
+    uint32_t size(void) const { return m_count; }
+
+    /**
+     * @brief Get the number of ticks the wheel can place without parking.
+     *
+     * @return uint64_t The range of the top level.
+     */
+    static uint64_t range(void) { return (uint64_t)1 << (SlotBits * Levels); }
+
+private:
+    static const uint16_t SLOTS = (uint16_t)(1u << SlotBits);
+    static const uint16_t MASK = SLOTS - 1;
+
+    static uint16_t slotIndex(uint64_t tick, uint8_t level)
+    {
+        return (uint16_t)((tick >> (SlotBits * level)) & MASK);
+    }
+
+    /**
+     * @brief Put the cursor of every level on the slot of m_now.
+     */
+    void syncCursors(void)
+    {
+        for (uint8_t l = 0; l < Levels; l++)
+        {
+            m_levels[l]->moveToIndex(slotIndex(m_now, l));
+        }
+    }
+
+    /**
+     * @brief Link a timer into the slot for its expiry tick.
+     *
+     * @param timer The timer.
+     * @param earliest First tick whose level 0 slot has not been fired yet.
+     */
+    void place(Entry &timer, uint64_t earliest)
+    {
+        uint64_t expires = timer.m_expires > earliest ? timer.m_expires : earliest;
+        uint64_t delta = expires - m_now;
+        uint8_t level = 0;
+
+        if (delta >= range())
+        {
+            // Park in the top level slot which is cascaded last
+            level = Levels - 1;
+            expires = m_now + range() - 1;
+        }
+        else
+        {
+            while (level + 1 < Levels && delta >= ((uint64_t)1 << (SlotBits * (level + 1))))
+            {
+                level++;
+            }
+        }
+
+        Entry *&slot = m_levels[level]->atIndex(slotIndex(expires, level));
+        timer.m_next = slot;
+        timer.m_pprev = &slot;
+        if (slot != NULL)
+            slot->m_pprev = &timer.m_next;
+        slot = &timer;
+    }
+
+    static void unlink(Entry &timer)
+    {
+        *timer.m_pprev = timer.m_next;
+        if (timer.m_next != NULL)
+            timer.m_next->m_pprev = timer.m_pprev;
+        timer.m_next = NULL;
+        timer.m_pprev = NULL;
+    }
+
+    /**
+     * @brief Advance the upper levels after level 0 wrapped.
+     *
+     * The highest level which wraps is cascaded first, so its timers can
+     * end up in a lower slot which is cascaded in the same call.
+     */
+    void cascade(void)
+    {
+        uint8_t top = 1;
+        while (top + 1 < Levels && slotIndex(m_now, top) == 0)
+        {
+            top++;
+        }
+
+        for (uint8_t l = top; l >= 1 && l < Levels; l--)
+        {
+            m_levels[l]->moveNext();
+            Entry *&slot = m_levels[l]->current();
+            while (slot != NULL)
+            {
+                Entry &timer = *slot;
+                unlink(timer);
+                place(timer, m_now);
+            }
+        }
+    }
+
+private:
+    RingBuffer<Entry *> *m_levels[Levels]; ///< Slots per level, current() is the slot of m_now.
+    uint64_t m_now;                        ///< Current tick.
+    uint32_t m_count;                      ///< Number of scheduled timers.
+    Entry *m_expired;                      ///< Timers of the slot being fired.
+};
+
+#endif
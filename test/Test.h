@@ -0,0 +1,63 @@
+#ifndef TEST_H
+#define TEST_H
+
+#include <stdint.h>
+
+typedef void (*TestCaseFunction)(void);
+
+/**
+ * @brief Registers a test case at static initialisation time.
+ */
+struct TestCase
+{
+    TestCase(const char *name, TestCaseFunction function);
+};
+
+/**
+ * @brief Define and register a test case.
+ */
+#define TEST_CASE(name)                                                  \
+    static void test_case_##name(void);                                  \
+    static TestCase test_case_registrar_##name(#name, test_case_##name); \
+    static void test_case_##name(void)
+
+/**
+ * @brief Record a failed check of the running test case.
+ *
+ * @param file source file of the check
+ * @param line source line of the check
+ * @param expression text of the failed expression
+ */
+void testFailure(const char *file, int line, const char *expression);
+
+/**
+ * @brief Check a condition, a failure is reported and the case goes on.
+ */
+#define CHECK(expression) \
+    ((expression) ? (void)0 : testFailure(__FILE__, __LINE__, #expression))
+
+/**
+ * @brief Check a condition, a failure ends the running test case.
+ */
+#define REQUIRE(expression)                                   \
+    do                                                        \
+    {                                                         \
+        if (!(expression))                                    \
+        {                                                     \
+            testFailure(__FILE__, __LINE__, #expression);     \
+            return;                                           \
+        }                                                     \
+    } while (0)
+
+/**
+ * @brief Deterministic xorshift32 generator for randomised cases.
+ */
+inline uint32_t testRandom(uint32_t &seed)
+{
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+    return seed;
+}
+
+#endif
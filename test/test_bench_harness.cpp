@@ -0,0 +1,111 @@
+/*
+ * Tests of the benchmark harness in benchmark/Bench.h. The driver hooks of
+ * bench_main.cpp are replaced by the stubs below.
+ */
+#include <vector>
+#include "Bench.h"
+#include "Test.h"
+
+static std::vector<BenchResult> g_reports;
+
+uint64_t benchOperations(void)
+{
+    return 1000;
+}
+
+uint64_t benchAllocations(void)
+{
+    return 0;
+}
+
+void benchReport(const BenchResult &result)
+{
+    g_reports.push_back(result);
+}
+
+void benchSink(uint64_t value)
+{
+    (void)value;
+}
+
+void benchCheck(bool ok, const char *what)
+{
+    CHECK(ok);
+    (void)what;
+}
+
+TEST_CASE(histogram_percentiles_within_bucket_error)
+{
+    LatencyHistogram histogram;
+    for (uint64_t v = 1; v <= 100000; v++)
+        histogram.record(v);
+
+    CHECK(histogram.count() == 100000);
+    CHECK(histogram.max() == 100000);
+
+    const double ps[] = {0.5, 0.99, 0.999};
+    for (uint8_t i = 0; i < 3; i++)
+    {
+        double exact = ps[i] * 100000;
+        double got = (double)histogram.percentile(ps[i]);
+        // Lower bound of an 8 way split power of two bucket
+        CHECK(got <= exact + 1 && got >= exact * 0.875 - 1);
+    }
+}
+
+TEST_CASE(histogram_small_values_are_exact_and_merge_adds)
+{
+    LatencyHistogram a;
+    LatencyHistogram b;
+    for (uint64_t v = 0; v < 8; v++)
+        a.record(v);
+    b.record(1u << 20);
+
+    CHECK(a.percentile(0.0) == 0);
+    CHECK(a.percentile(0.5) == 4);
+    a.merge(b);
+    CHECK(a.count() == 9);
+    CHECK(a.max() == (1u << 20));
+    CHECK(a.percentile(1.0) == (1u << 20));
+}
+
+TEST_CASE(bench_run_calls_setup_per_batch_and_op_per_operation)
+{
+    uint64_t setups = 0;
+    uint64_t ops = 0;
+    uint64_t indexSum = 0;
+    BenchCase params = {"Test", "batched", 4, 16, 1};
+
+    g_reports.clear();
+    benchRun(params, 300, [&]() { setups++; }, [&](uint64_t i) {
+        ops++;
+        indexSum += i;
+    });
+
+    // 1000 operations are cut to 3 full batches, measured twice
+    REQUIRE(g_reports.size() == 1);
+    CHECK(g_reports[0].operations == 900);
+    CHECK(setups == 6);
+    CHECK(ops == 1800);
+    CHECK(indexSum == 2 * (899 * 900 / 2));
+    CHECK(g_reports[0].p50 <= g_reports[0].p99 && g_reports[0].p99 <= g_reports[0].p999);
+    CHECK(g_reports[0].p999 <= g_reports[0].max);
+}
+
+TEST_CASE(bench_run_threads_splits_operations)
+{
+    std::atomic<uint64_t> ops(0);
+    std::atomic<uint32_t> threadMask(0);
+    BenchCase params = {"Test", "threads", 4, 16, 4};
+
+    g_reports.clear();
+    benchRunThreads(params, [&](uint32_t t, uint64_t) {
+        ops++;
+        threadMask |= 1u << t;
+    });
+
+    REQUIRE(g_reports.size() == 1);
+    CHECK(g_reports[0].operations == 1000);
+    CHECK(ops.load() == 2000);
+    CHECK(threadMask.load() == 0xF);
+}
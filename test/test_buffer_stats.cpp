@@ -0,0 +1,140 @@
+/*
+ * Statistics policy tests for FiFo and RingBuffer.
+ */
+#include "FiFo.h"
+#include "RingBuffer.h"
+#include "Test.h"
+
+TEST_CASE(fifo_stats_count_traffic)
+{
+    uint8_t storage[8];
+    FiFo<uint8_t, BufferStats> fifo;
+    fifo.initBuffer(storage, sizeof(storage));
+
+    for (uint8_t i = 0; i < 6; i++)
+        CHECK(fifo.write(&i));
+    fifo.read();
+    fifo.read();
+    for (uint8_t i = 0; i < 4; i++)
+        CHECK(fifo.write(&i));
+
+    BufferStatistics_t stats = fifo.getStatistics();
+    CHECK(stats.pushed == 10);
+    CHECK(stats.popped == 2);
+    CHECK(stats.wraps == 1);
+    CHECK(stats.highWater == 8);
+    CHECK(stats.capacity == 8);
+    CHECK(stats.rejected == 0 && stats.overwritten == 0);
+
+    // Fill levels after the writes: 1..6, then 5..8
+    uint32_t total = 0;
+    for (uint8_t i = 0; i < BUFFER_STATS_HISTOGRAM_BINS; i++)
+        total += stats.occupancy[i];
+    CHECK(total == 10);
+    CHECK(stats.occupancy[0] == 0);
+    CHECK(stats.occupancy[5] == 2 && stats.occupancy[6] == 2 && stats.occupancy[7] == 2);
+
+    // A write into the full FIFO overwrites, the broken FIFO rejects the next one
+    uint8_t value = 0;
+    fifo.write(&value);
+    CHECK(!fifo.write(&value));
+    stats = fifo.getStatistics();
+    CHECK(stats.overwritten == 1);
+    CHECK(stats.rejected == 1);
+
+    fifo.resetStatistics();
+    stats = fifo.getStatistics();
+    CHECK(stats.pushed == 0 && stats.popped == 0 && stats.wraps == 0 && stats.highWater == 0);
+    CHECK(stats.overwritten == 0 && stats.rejected == 0 && stats.occupancy[7] == 0);
+}
+
+TEST_CASE(fifo_batched_paths_are_counted)
+{
+    uint32_t storage[16];
+    uint32_t out[16];
+    FiFo<uint32_t, BufferStats> fifo;
+    fifo.initBuffer((uint8_t *)storage, sizeof(storage));
+
+    CHECK(fifo.fill(10, [](uint32_t *slots, uint16_t n) {
+        for (uint16_t i = 0; i < n; i++)
+            slots[i] = i;
+        return n;
+    }) == 10);
+    CHECK(fifo.drain_into(out, 4) == 4);
+    CHECK(fifo.drain(3, [](const uint32_t *, uint16_t) {}) == 3);
+
+    BufferStatistics_t stats = fifo.getStatistics();
+    CHECK(stats.pushed == 10);
+    CHECK(stats.popped == 7);
+    CHECK(stats.highWater == 10 * sizeof(uint32_t));
+}
+
+TEST_CASE(fifo_without_stats_reports_zero)
+{
+    uint8_t storage[8];
+    FiFo<uint8_t> fifo;
+    fifo.initBuffer(storage, sizeof(storage));
+    uint8_t value = 1;
+    fifo.write(&value);
+
+    BufferStatistics_t stats = fifo.getStatistics();
+    CHECK(stats.pushed == 0 && stats.highWater == 0);
+    CHECK(stats.capacity == 8);
+}
+
+TEST_CASE(ring_buffer_stats_count_overwrites_and_wraps)
+{
+    RingBuffer<int, BufferStats> ring(4);
+    for (int i = 0; i < 6; i++)
+        ring.add(i);
+
+    BufferStatistics_t stats = ring.getStatistics();
+    CHECK(stats.pushed == 6);
+    CHECK(stats.overwritten == 2);
+    CHECK(stats.wraps == 1);
+    CHECK(stats.highWater == 4);
+    CHECK(stats.capacity == 4);
+
+    ring.resetStatistics();
+    CHECK(ring.getStatistics().pushed == 0);
+}
+
+TEST_CASE(ring_buffer_stats_keep_overwrites_after_reset)
+{
+    RingBuffer<int, BufferStats> ring(4);
+    for (int i = 0; i < 4; i++)
+        ring.add(i);
+    CHECK(ring.getStatistics().overwritten == 0);
+
+    // The ring stays full, every further add replaces an element
+    ring.resetStatistics();
+    for (int i = 0; i < 3; i++)
+        ring.add(i);
+
+    BufferStatistics_t stats = ring.getStatistics();
+    CHECK(stats.pushed == 3);
+    CHECK(stats.overwritten == 3);
+    CHECK(stats.highWater == 4);
+    CHECK(stats.occupancy[BUFFER_STATS_HISTOGRAM_BINS - 1] == 3);
+}
+
+TEST_CASE(ring_buffer_stats_count_rewrites_of_one_slot)
+{
+    RingBuffer<int, BufferStats> ring(8);
+    int value = 1;
+
+    for (int i = 0; i < 5; i++)
+        ring.add((uint16_t)3, value);
+    BufferStatistics_t stats = ring.getStatistics();
+    CHECK(stats.pushed == 5);
+    CHECK(stats.overwritten == 4);
+    CHECK(stats.highWater == 1);
+
+    // Adds without moving on rewrite the current slot as well
+    ring.add(value, false);
+    ring.add(value, false);
+    ring.add((uint16_t)7, value);
+    stats = ring.getStatistics();
+    CHECK(stats.overwritten == 5);
+    CHECK(stats.highWater == 3);
+}
@@ -0,0 +1,190 @@
+/*
+ * FiFoChannel tests, only built with C++20 coroutine support.
+ */
+#include "FiFoChannel.h"
+#include "Test.h"
+
+#if defined(__cpp_impl_coroutine) && __cpp_impl_coroutine >= 201902L
+
+#include <exception>
+#include <vector>
+
+struct DetachedTask
+{
+    struct promise_type
+    {
+        DetachedTask get_return_object(void) { return DetachedTask(); }
+        std::suspend_never initial_suspend(void) { return std::suspend_never(); }
+        std::suspend_never final_suspend(void) noexcept { return std::suspend_never(); }
+        void return_void(void) {}
+        void unhandled_exception(void) { std::terminate(); }
+    };
+};
+
+/**
+ * @brief Executor which records whether a coroutine is resumed from schedule().
+ */
+struct CheckingExecutor
+{
+    FiFoChannelExecutor queue;
+    bool scheduling = false;
+    bool nested = false;
+    uint32_t scheduled = 0;
+
+    void schedule(FiFoChannelTask &task)
+    {
+        nested = nested || scheduling;
+        scheduling = true;
+        queue.schedule(task);
+        scheduled++;
+        scheduling = false;
+    }
+    uint32_t run(void) { return queue.run(); }
+};
+
+typedef FiFoChannel<uint32_t, CheckingExecutor> Channel;
+
+struct Storage
+{
+    std::vector<uint32_t> words;
+    FiFo<uint32_t> fifo;
+
+    explicit Storage(uint16_t depth) : words(depth + 1)
+    {
+        fifo.initBuffer((uint8_t *)&words[0], (uint16_t)(depth * sizeof(uint32_t)));
+    }
+};
+
+static DetachedTask collect(Channel &channel, std::vector<uint32_t> &out, bool &finished)
+{
+    while (std::optional<uint32_t> value = co_await channel.read())
+        out.push_back(*value);
+    finished = true;
+}
+
+static DetachedTask produce(Channel &channel, uint32_t first, uint32_t count, uint32_t &accepted)
+{
+    for (uint32_t i = 0; i < count; i++)
+    {
+        if (co_await channel.write(first + i))
+            accepted++;
+    }
+}
+
+TEST_CASE(channel_keeps_order_through_small_fifo)
+{
+    Storage storage(4);
+    CheckingExecutor executor;
+    Channel channel(storage.fifo, executor);
+    std::vector<uint32_t> out;
+    bool finished = false;
+    uint32_t accepted = 0;
+
+    collect(channel, out, finished);
+    produce(channel, 0, 1000, accepted);
+    executor.run();
+    CHECK(accepted == 1000);
+    CHECK(!finished);
+
+    channel.close();
+    executor.run();
+    CHECK(finished);
+    REQUIRE(out.size() == 1000);
+    for (uint32_t i = 0; i < out.size(); i++)
+        CHECK(out[i] == i);
+    CHECK(!executor.nested);
+}
+
+TEST_CASE(channel_queues_many_writers_without_resuming_inline)
+{
+    // Far more suspended writers than any fixed run queue would hold
+    Storage storage(2);
+    CheckingExecutor executor;
+    Channel channel(storage.fifo, executor);
+    std::vector<uint32_t> out;
+    bool finished = false;
+    uint32_t accepted = 0;
+
+    for (uint32_t w = 0; w < 500; w++)
+        produce(channel, w, 1, accepted);
+    CHECK(accepted == 2);
+    CHECK(executor.scheduled == 0);
+
+    collect(channel, out, finished);
+    // Woken writers only run from the executor
+    CHECK(accepted == 2);
+    CHECK(executor.run() == 498);
+    CHECK(accepted == 500);
+    CHECK(!executor.nested);
+
+    channel.close();
+    executor.run();
+    CHECK(finished);
+    REQUIRE(out.size() == 500);
+    for (uint32_t i = 0; i < out.size(); i++)
+        CHECK(out[i] == i);
+}
+
+TEST_CASE(channel_hands_over_to_waiting_reader)
+{
+    Storage storage(4);
+    CheckingExecutor executor;
+    Channel channel(storage.fifo, executor);
+    std::vector<uint32_t> out;
+    bool finished = false;
+    uint32_t accepted = 0;
+
+    collect(channel, out, finished);
+    produce(channel, 42, 1, accepted);
+
+    // The reader got the element directly, the writer waits in the executor
+    REQUIRE(out.size() == 1);
+    CHECK(out[0] == 42);
+    CHECK(!storage.fifo.dataAvailable());
+    CHECK(accepted == 0);
+    CHECK(executor.run() == 1);
+    CHECK(accepted == 1);
+
+    channel.close();
+    executor.run();
+    CHECK(finished);
+}
+
+TEST_CASE(channel_close_wakes_readers_and_writers)
+{
+    Storage storage(1);
+    CheckingExecutor executor;
+    std::vector<uint32_t> out;
+    bool finished[3] = {false, false, false};
+    uint32_t accepted = 0;
+
+    {
+        // Suspended readers get nullopt
+        Channel channel(storage.fifo, executor);
+        collect(channel, out, finished[0]);
+        collect(channel, out, finished[1]);
+        channel.close();
+        CHECK(!finished[0] && !finished[1]);
+        CHECK(executor.run() == 2);
+        CHECK(finished[0] && finished[1]);
+        CHECK(out.empty());
+    }
+    {
+        // Suspended writers get false, buffered elements stay readable
+        Channel channel(storage.fifo, executor);
+        produce(channel, 7, 3, accepted);
+        CHECK(accepted == 1);
+        channel.close();
+        executor.run();
+        CHECK(accepted == 1);
+        CHECK(channel.closed());
+
+        collect(channel, out, finished[2]);
+        CHECK(finished[2]);
+        REQUIRE(out.size() == 1);
+        CHECK(out[0] == 7);
+    }
+    CHECK(!executor.nested);
+}
+
+#endif
@@ -0,0 +1,102 @@
+/*
+ * CompressedRingBuffer tests against a plain sample history as reference.
+ */
+#include <limits.h>
+#include <vector>
+#include "CompressedRingBuffer.h"
+#include "Test.h"
+
+template <uint16_t BlockBytes>
+static bool sameTail(CompressedRingBuffer<BlockBytes> &ring, const std::vector<int32_t> &history)
+{
+    uint32_t length = ring.length();
+    bool same = length <= history.size();
+    std::vector<int32_t> out(length + 1);
+
+    same = same && ring.decode(0, &out[0], length + 1) == length;
+    for (uint32_t i = 0; same && i < length; i++)
+        same = out[i] == history[history.size() - length + i];
+    return same;
+}
+
+TEST_CASE(compressed_ring_buffer_round_trips_extreme_deltas)
+{
+    CompressedRingBuffer<16> ring(64);
+    std::vector<int32_t> history;
+    const int32_t values[] = {0, 1, -1, 63, -64, 64, -65, 8191, -8192, INT32_MAX, INT32_MIN,
+                              INT32_MAX, 0, INT32_MIN, -1, 1 << 20, -(1 << 27), 5};
+
+    for (uint32_t i = 0; i < sizeof(values) / sizeof(values[0]); i++)
+    {
+        ring.add(values[i]);
+        history.push_back(values[i]);
+        CHECK(ring.current() == values[i]);
+        CHECK(ring.at(-1) == values[i]);
+    }
+    CHECK(ring.length() == history.size());
+    CHECK(sameTail(ring, history));
+    for (uint32_t i = 0; i < history.size(); i++)
+        CHECK(ring.atIndex(i) == history[i]);
+}
+
+TEST_CASE(compressed_ring_buffer_drops_oldest_blocks_and_matches_reference)
+{
+    CompressedRingBuffer<32> ring(8);
+    std::vector<int32_t> history;
+    uint32_t seed = 4711;
+    int32_t value = 1000;
+
+    for (uint32_t step = 0; step < 20000; step++)
+    {
+        uint32_t r = testRandom(seed);
+        // Mostly slow drift, sometimes a large jump
+        if (r % 50 == 0)
+            value = (int32_t)testRandom(seed);
+        else
+            value += (int32_t)(r % 7) - 3;
+        ring.add(value);
+        history.push_back(value);
+
+        uint32_t length = ring.length();
+        CHECK(length > 0 && length <= history.size());
+        CHECK(ring.usedBlocks() <= ring.blocks());
+        if (step % 97 == 0)
+        {
+            CHECK(sameTail(ring, history));
+            uint32_t idx = testRandom(seed) % length;
+            int32_t out[40];
+            uint32_t n = ring.decode(idx, out, 40);
+            CHECK(n == (length - idx < 40 ? length - idx : 40));
+            for (uint32_t i = 0; i < n; i++)
+                CHECK(out[i] == history[history.size() - length + idx + i]);
+            int32_t offset = -(int32_t)(1 + testRandom(seed) % length);
+            CHECK(ring.at(offset) == history[history.size() + offset]);
+        }
+    }
+    // Only whole blocks are dropped, the kept history fills most of them
+    CHECK(ring.usedBlocks() == ring.blocks());
+    CHECK(ring.length() >= 7u * 32u / 5u);
+}
+
+TEST_CASE(compressed_ring_buffer_out_of_range)
+{
+    CompressedRingBuffer<8> ring(2);
+    int32_t out[4] = {9, 9, 9, 9};
+
+    CHECK(ring.length() == 0);
+    CHECK(ring.at(-1) == 0);
+    CHECK(ring.decode(0, out, 4) == 0);
+
+    ring.add(-5);
+    ring.add(7);
+    CHECK(ring.at(0) == 0);
+    CHECK(ring.at(-3) == 0);
+    CHECK(ring.at(-2) == -5);
+    CHECK(ring.atIndex(2) == 0);
+    CHECK(ring.decode(2, out, 4) == 0);
+    CHECK(ring.decode(1, out, 4) == 1 && out[0] == 7);
+
+    ring.clear();
+    CHECK(ring.length() == 0 && ring.usedBlocks() == 0);
+    CHECK(ring.current() == 0);
+}
@@ -0,0 +1,136 @@
+/*
+ * FiFoFanIn tests.
+ */
+#include <vector>
+#include "FiFoFanIn.h"
+#include "Test.h"
+
+typedef FiFoFanIn<uint32_t, 40> FanIn;
+
+struct Channels
+{
+    std::vector<uint32_t> storage;
+    FiFo<uint32_t> fifos[40];
+
+    explicit Channels(uint16_t depth) : storage(40 * depth)
+    {
+        for (uint16_t i = 0; i < 40; i++)
+            fifos[i].initBuffer((uint8_t *)&storage[i * depth], (uint16_t)(depth * sizeof(uint32_t)));
+    }
+};
+
+TEST_CASE(fan_in_shares_by_weight)
+{
+    Channels channels(128);
+    FanIn fanIn(8);
+    const uint16_t weights[3] = {1, 2, 4};
+    uint32_t served[3] = {0, 0, 0};
+
+    for (uint16_t c = 0; c < 3; c++)
+    {
+        CHECK(fanIn.attach(c, &channels.fifos[c], weights[c]));
+        for (uint32_t i = 0; i < 100; i++)
+            CHECK(fanIn.write(c, i));
+    }
+
+    for (uint8_t round = 0; round < 10; round++)
+        fanIn.dispatch([&](uint16_t channel, uint32_t &) { served[channel]++; });
+
+    CHECK(served[0] == 10);
+    CHECK(served[1] == 20);
+    CHECK(served[2] == 40);
+}
+
+TEST_CASE(fan_in_delivers_everything_in_channel_order)
+{
+    Channels channels(64);
+    FanIn fanIn(4);
+    uint32_t seed = 99;
+    uint32_t written = 0;
+    uint32_t next[40] = {0};
+    uint32_t expected[40] = {0};
+    bool ordered = true;
+
+    for (uint16_t c = 0; c < 40; c++)
+        fanIn.attach(c, &channels.fifos[c], (uint16_t)(1 + c % 3));
+
+    uint32_t delivered = 0;
+    for (uint32_t step = 0; step < 5000; step++)
+    {
+        uint16_t c = (uint16_t)(testRandom(seed) % 40);
+        if (channels.fifos[c].getFreeBufferSpace() >= sizeof(uint32_t))
+        {
+            uint32_t value = next[c]++;
+            CHECK(fanIn.write(c, value));
+            written++;
+        }
+        if (step % 7 == 0)
+        {
+            delivered += fanIn.dispatch([&](uint16_t channel, uint32_t &value) {
+                ordered = ordered && value == expected[channel];
+                expected[channel]++;
+            }, testRandom(seed) % 32);
+        }
+    }
+    while (fanIn.dataAvailable())
+    {
+        delivered += fanIn.dispatch([&](uint16_t channel, uint32_t &value) {
+            ordered = ordered && value == expected[channel];
+            expected[channel]++;
+        });
+    }
+
+    CHECK(ordered);
+    CHECK(delivered == written);
+    for (uint16_t c = 0; c < 40; c++)
+        CHECK(!fanIn.isReady(c));
+}
+
+TEST_CASE(fan_in_tracks_ready_channels_across_words)
+{
+    Channels channels(8);
+    FanIn fanIn;
+    uint32_t value = 7;
+
+    fanIn.attach(3, &channels.fifos[3]);
+    fanIn.attach(35, &channels.fifos[35]);
+    CHECK(!fanIn.dataAvailable());
+
+    // Direct writes need notify()
+    channels.fifos[35].write(&value);
+    CHECK(!fanIn.isReady(35));
+    fanIn.notify(35);
+    CHECK(fanIn.isReady(35));
+    CHECK(fanIn.write(3, value));
+
+    uint16_t order[2] = {0, 0};
+    uint8_t n = 0;
+    CHECK(fanIn.dispatch([&](uint16_t channel, uint32_t &) { order[n++] = channel; }) == 2);
+    CHECK(order[0] == 3 && order[1] == 35);
+    CHECK(!fanIn.dataAvailable());
+
+    // Writes into unattached channels are refused
+    CHECK(!fanIn.write(4, value));
+    CHECK(!fanIn.attach(40, &channels.fifos[0]));
+}
+
+TEST_CASE(fan_in_budget_resumes_round_robin)
+{
+    Channels channels(16);
+    FanIn fanIn(1);
+    for (uint16_t c = 0; c < 4; c++)
+    {
+        fanIn.attach(c, &channels.fifos[c]);
+        for (uint32_t i = 0; i < 4; i++)
+            fanIn.write(c, i);
+    }
+
+    std::vector<uint16_t> order;
+    for (uint8_t call = 0; call < 4; call++)
+        CHECK(fanIn.dispatch([&](uint16_t channel, uint32_t &) { order.push_back(channel); }, 3) == 3);
+
+    // Each call continues after the channel served last
+    REQUIRE(order.size() == 12);
+    for (size_t i = 0; i < order.size(); i++)
+        CHECK(order[i] == i % 4);
+}
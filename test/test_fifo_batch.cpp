@@ -0,0 +1,128 @@
+/*
+ * FiFo batched drain()/drain_into()/fill() tests against std::deque as reference.
+ */
+#include <deque>
+#include <vector>
+#include "FiFo.h"
+#include "Test.h"
+
+typedef std::deque<uint32_t> Reference;
+
+static void randomBatches(uint8_t *buffer, uint16_t size, uint32_t seed)
+{
+    FiFo<uint32_t> fifo;
+    Reference reference;
+    uint32_t next = 0;
+
+    fifo.initBuffer(buffer, size);
+    for (uint32_t step = 0; step < 20000; step++)
+    {
+        uint32_t op = testRandom(seed) % 5;
+        uint16_t max_n = (uint16_t)(testRandom(seed) % 12);
+        uint16_t room = (uint16_t)(fifo.getFreeBufferSpace() / sizeof(uint32_t));
+        uint16_t stored = (uint16_t)(fifo.getUsedBufferSize() / sizeof(uint32_t));
+
+        if (op == 0 && room > 0)
+        {
+            // write() itself does not check for space
+            uint32_t value = next;
+            CHECK(fifo.write(&value));
+            reference.push_back(next++);
+        }
+        else if (op == 1)
+        {
+            // The generator may stop short of the offered slots
+            uint16_t limit = (uint16_t)(testRandom(seed) % 12);
+            uint16_t produced = 0;
+            uint16_t n = fifo.fill(max_n, [&](uint32_t *slots, uint16_t count) -> uint16_t {
+                uint16_t k = 0;
+                while (k < count && produced < limit)
+                {
+                    slots[k++] = next;
+                    reference.push_back(next++);
+                    produced++;
+                }
+                return k;
+            });
+            uint16_t expected = max_n < room ? max_n : room;
+            CHECK(n == (expected < limit ? expected : limit));
+        }
+        else if (op == 2)
+        {
+            uint16_t expected = max_n < stored ? max_n : stored;
+            uint16_t seen = 0;
+            bool same = true;
+            uint16_t n = fifo.drain(max_n, [&](const uint32_t *chunk, uint16_t count) {
+                for (uint16_t k = 0; k < count; k++)
+                    same = same && chunk[k] == reference[seen + k];
+                seen += count;
+            });
+            CHECK(n == expected);
+            CHECK(seen == expected);
+            CHECK(same);
+            reference.erase(reference.begin(), reference.begin() + n);
+        }
+        else if (op == 3)
+        {
+            uint32_t out[12];
+            uint16_t n = fifo.drain_into(out, max_n);
+            CHECK(n == (max_n < stored ? max_n : stored));
+            for (uint16_t k = 0; k < n; k++)
+                CHECK(out[k] == reference[k]);
+            reference.erase(reference.begin(), reference.begin() + n);
+        }
+        else if (op == 4 && !reference.empty())
+        {
+            CHECK(fifo.read() == reference.front());
+            reference.pop_front();
+        }
+        CHECK(fifo.getUsedBufferSize() == reference.size() * sizeof(uint32_t));
+    }
+}
+
+TEST_CASE(fifo_batch_aligned_buffer_matches_reference)
+{
+    std::vector<uint32_t> storage(16);
+    randomBatches((uint8_t *)&storage[0], 64, 1);
+}
+
+TEST_CASE(fifo_batch_unaligned_size_matches_reference)
+{
+    // 30 bytes is no multiple of the element size, elements straddle the end
+    std::vector<uint32_t> storage(8);
+    randomBatches((uint8_t *)&storage[0], 30, 2);
+}
+
+TEST_CASE(fifo_batch_unaligned_address_matches_reference)
+{
+    std::vector<uint32_t> storage(17);
+    randomBatches((uint8_t *)&storage[0] + 1, 64, 3);
+}
+
+TEST_CASE(fifo_batch_drain_splits_at_wraparound)
+{
+    std::vector<uint32_t> storage(8);
+    FiFo<uint32_t> fifo;
+    uint32_t chunks = 0;
+    uint32_t value;
+
+    fifo.initBuffer((uint8_t *)&storage[0], 32);
+    for (value = 0; value < 6; value++)
+        fifo.write(&value);
+    uint32_t out[4];
+    CHECK(fifo.drain_into(out, 4) == 4);
+    CHECK(out[0] == 0 && out[3] == 3);
+    for (; value < 10; value++)
+        fifo.write(&value);
+
+    value = 4;
+    CHECK(fifo.drain(100, [&](const uint32_t *chunk, uint16_t count) {
+        for (uint16_t k = 0; k < count; k++)
+            CHECK(chunk[k] == value++);
+        chunks++;
+    }) == 6);
+    CHECK(chunks == 2);
+    CHECK(!fifo.dataAvailable());
+    CHECK(fifo.drain(4, [&](const uint32_t *, uint16_t) { chunks++; }) == 0);
+    CHECK(chunks == 2);
+}
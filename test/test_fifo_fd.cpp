@@ -0,0 +1,140 @@
+/*
+ * FiFo write_to_fd()/read_from_fd() tests over a pipe.
+ */
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <vector>
+#include "FiFo.h"
+#include "Test.h"
+
+struct Pipe
+{
+    int fd[2];
+
+    Pipe() : fd{-1, -1}
+    {
+        if (pipe(fd) == 0)
+        {
+            fcntl(fd[0], F_SETFL, O_NONBLOCK);
+            fcntl(fd[1], F_SETFL, O_NONBLOCK);
+        }
+    }
+    ~Pipe()
+    {
+        closeWriter();
+        if (fd[0] >= 0)
+            close(fd[0]);
+    }
+    void closeWriter(void)
+    {
+        if (fd[1] >= 0)
+            close(fd[1]);
+        fd[1] = -1;
+    }
+};
+
+TEST_CASE(fifo_fd_round_trip_across_wraparound)
+{
+    Pipe p;
+    uint8_t in[100];
+    uint8_t out[100];
+    FiFo<uint8_t> source;
+    FiFo<uint8_t> sink;
+    uint32_t seed = 3;
+    uint8_t next = 0;
+    uint8_t expected = 0;
+    bool same = true;
+
+    REQUIRE(p.fd[0] >= 0);
+    source.initBuffer(in, sizeof(in));
+    sink.initBuffer(out, sizeof(out));
+
+    for (uint32_t step = 0; step < 5000; step++)
+    {
+        uint16_t n = (uint16_t)(testRandom(seed) % 60);
+        for (uint16_t i = 0; i < n && source.getFreeBufferSpace() > 0; i++)
+        {
+            source.write(&next);
+            next++;
+        }
+
+        ssize_t written = source.write_to_fd(p.fd[1], (uint16_t)(testRandom(seed) % 80));
+        CHECK(written >= 0);
+
+        ssize_t read = sink.read_from_fd(p.fd[0], (uint16_t)(1 + testRandom(seed) % 80));
+        CHECK(read > 0 || (read == -1 && (errno == EAGAIN || errno == ENOBUFS)));
+
+        uint16_t drain = (uint16_t)(testRandom(seed) % 70);
+        for (uint16_t i = 0; i < drain && sink.dataAvailable(); i++)
+            same = same && sink.read() == expected++;
+    }
+    CHECK(same);
+    CHECK(expected > 100);
+}
+
+TEST_CASE(fifo_fd_full_fifo_is_enobufs_not_eof)
+{
+    Pipe p;
+    uint8_t storage[16];
+    uint8_t data[32];
+    FiFo<uint8_t> fifo;
+
+    REQUIRE(p.fd[0] >= 0);
+    for (uint8_t i = 0; i < sizeof(data); i++)
+        data[i] = i;
+    REQUIRE(write(p.fd[1], data, sizeof(data)) == (ssize_t)sizeof(data));
+
+    fifo.initBuffer(storage, sizeof(storage));
+    CHECK(fifo.read_from_fd(p.fd[0], 100) == 16);
+
+    // Full: nothing is taken from the pipe
+    errno = 0;
+    CHECK(fifo.read_from_fd(p.fd[0], 100) == -1);
+    CHECK(errno == ENOBUFS);
+    errno = 0;
+    CHECK(fifo.read_from_fd(p.fd[0], 0) == -1);
+    CHECK(errno == ENOBUFS);
+
+    for (uint8_t i = 0; i < 16; i++)
+        CHECK(fifo.read() == i);
+    CHECK(fifo.read_from_fd(p.fd[0], 100) == 16);
+    for (uint8_t i = 16; i < 32; i++)
+        CHECK(fifo.read() == i);
+
+    // Empty pipe, then end of file
+    errno = 0;
+    CHECK(fifo.read_from_fd(p.fd[0], 100) == -1);
+    CHECK(errno == EAGAIN);
+    p.closeWriter();
+    CHECK(fifo.read_from_fd(p.fd[0], 100) == 0);
+
+    FiFo<uint8_t> unused;
+    errno = 0;
+    CHECK(unused.read_from_fd(p.fd[0], 100) == -1);
+    CHECK(errno == ENOBUFS);
+}
+
+TEST_CASE(fifo_fd_write_keeps_unaccepted_bytes)
+{
+    Pipe p;
+    uint8_t storage[64];
+    FiFo<uint8_t> fifo;
+    uint8_t value = 1;
+
+    REQUIRE(p.fd[0] >= 0);
+    fifo.initBuffer(storage, sizeof(storage));
+    CHECK(fifo.write_to_fd(p.fd[1], 64) == 0);
+
+    // Fill the pipe until the kernel refuses more
+    std::vector<uint8_t> block(4096, 0xAA);
+    while (write(p.fd[1], &block[0], block.size()) > 0)
+    {
+    }
+    for (uint8_t i = 0; i < 10; i++)
+        fifo.write(&value);
+    errno = 0;
+    CHECK(fifo.write_to_fd(p.fd[1], 64) == -1);
+    CHECK(errno == EAGAIN);
+    CHECK(fifo.getUsedBufferSize() == 10);
+}
@@ -0,0 +1,115 @@
+/*
+ * Latency trace policy tests.
+ */
+#include <chrono>
+#include <string.h>
+#include <thread>
+#include "FiFo.h"
+#include "Test.h"
+
+typedef FiFo<uint8_t, BufferNoStats, FiFoLatencyTrace> TracedBytes;
+
+TEST_CASE(trace_measures_queueing_delay)
+{
+    uint8_t storage[16];
+    BufferTimestamp_t stamps[16];
+    TracedBytes fifo;
+    fifo.initBuffer(storage, sizeof(storage));
+    fifo.initTrace(stamps, 16);
+
+    for (uint8_t i = 0; i < 4; i++)
+        fifo.write(&i);
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    for (uint8_t i = 0; i < 4; i++)
+        fifo.read();
+
+    FIFO_Latency_t latency = fifo.getLatency();
+    CHECK(latency.count == 4);
+    CHECK(latency.dropped == 0);
+    CHECK(latency.max >= 2000000u);
+    CHECK(latency.p50 >= 1000000u && latency.p50 <= latency.max);
+    CHECK(latency.p99 >= latency.p50);
+}
+
+TEST_CASE(trace_counts_elements_without_stamp_as_dropped)
+{
+    uint8_t storage[16];
+    BufferTimestamp_t stamps[4];
+    TracedBytes fifo;
+    fifo.initBuffer(storage, sizeof(storage));
+    fifo.initTrace(stamps, 4);
+
+    for (uint8_t i = 0; i < 6; i++)
+        fifo.write(&i);
+    for (uint8_t i = 0; i < 6; i++)
+        fifo.read();
+
+    FIFO_Latency_t latency = fifo.getLatency();
+    CHECK(latency.count == 4);
+    CHECK(latency.dropped == 2);
+}
+
+TEST_CASE(trace_counts_elements_of_byte_writes)
+{
+    uint16_t storage[8];
+    BufferTimestamp_t stamps[3];
+    FiFo<uint16_t, BufferNoStats, FiFoLatencyTrace> fifo;
+    const uint16_t values[3] = {1, 2, 3};
+
+    fifo.initBuffer((uint8_t *)storage, sizeof(storage));
+    fifo.initTrace(stamps, 3);
+
+    // Six bytes are three elements, one stamp each
+    CHECK(fifo.write((uint16_t *)values, sizeof(values), 1));
+    CHECK(fifo.read() == 1);
+    CHECK(fifo.read() == 2);
+    CHECK(fifo.read() == 3);
+
+    FIFO_Latency_t latency = fifo.getLatency();
+    CHECK(latency.count == 3);
+    CHECK(latency.dropped == 0);
+}
+
+TEST_CASE(trace_export_lists_named_fifos)
+{
+    uint8_t storage[8];
+    BufferTimestamp_t stamps[8];
+    TracedBytes fifo;
+    uint8_t value = 0;
+    fifo.initBuffer(storage, sizeof(storage));
+    fifo.initTrace(stamps, 8);
+    fifo.setTraceName("uart_rx");
+    fifo.write(&value);
+    fifo.read();
+
+    uint32_t found = 0;
+    FiFoLatencyTrace::exportAll([](const FIFO_Latency_t &latency, void *context) {
+        if (latency.name != NULL && strcmp(latency.name, "uart_rx") == 0 && latency.count == 1)
+            (*(uint32_t *)context)++;
+    }, &found);
+    CHECK(found == 1);
+}
+
+TEST_CASE(trace_producer_and_consumer_threads)
+{
+    const uint32_t total = 200000;
+    BufferTimestamp_t stamps[64];
+    FiFoLatencyTrace trace;
+    std::atomic<bool> done(false);
+
+    trace.initTrace(stamps, 64);
+    std::thread consumer([&]() {
+        while (!done.load(std::memory_order_acquire))
+            trace.dequeued();
+        for (uint32_t i = 0; i < 64; i++)
+            trace.dequeued();
+    });
+    for (uint32_t i = 0; i < total; i++)
+        trace.enqueued(1);
+    done.store(true, std::memory_order_release);
+    consumer.join();
+
+    FIFO_Latency_t latency;
+    trace.latency(latency);
+    CHECK(latency.count + latency.dropped == total);
+}
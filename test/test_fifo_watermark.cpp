@@ -0,0 +1,181 @@
+/*
+ * FiFoWatermarks tests: every crossing is reported exactly once and the
+ * marks alternate.
+ */
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "FiFo.h"
+#include "Test.h"
+
+typedef FiFo<uint8_t, BufferNoStats, FiFoNoTrace, FiFoWatermarks> MarkedBytes;
+
+struct Report
+{
+    FIFO_Watermark_e mark;
+    uint16_t used;
+};
+
+static void record(FIFO_Watermark_e mark, uint16_t used, void *context)
+{
+    Report r = {mark, used};
+    ((std::vector<Report> *)context)->push_back(r);
+}
+
+TEST_CASE(fifo_watermark_reports_each_crossing_once)
+{
+    uint8_t storage[64];
+    uint8_t data[16] = {0};
+    MarkedBytes fifo;
+    std::vector<Report> reports;
+    uint32_t seed = 5;
+    bool armedHigh = true;
+    uint32_t expected = 0;
+
+    fifo.initBuffer(storage, sizeof(storage));
+    fifo.setWatermarks(48, 16, record, &reports);
+    for (uint32_t step = 0; step < 20000; step++)
+    {
+        uint32_t op = testRandom(seed) % 6;
+        uint16_t n = (uint16_t)(1 + testRandom(seed) % 12);
+        uint16_t free = fifo.getFreeBufferSpace();
+        uint16_t used = fifo.getUsedBufferSize();
+
+        if (op == 0 && free > 0)
+            fifo.write(data);
+        else if (op == 1 && free > 0)
+            fifo.write(data, n < free ? n : free);
+        else if (op == 2)
+            fifo.fill(n, [&](uint8_t *slots, uint16_t count) -> uint16_t { (void)slots; return count; });
+        else if (op == 3 && used > 0)
+            fifo.read();
+        else if (op == 4)
+            fifo.drain(n, [&](const uint8_t *, uint16_t) {});
+        else
+            fifo.drain_into(data, n);
+
+        used = fifo.getUsedBufferSize();
+        if (armedHigh && used >= 48)
+        {
+            armedHigh = false;
+            expected++;
+        }
+        else if (!armedHigh && used <= 16)
+        {
+            armedHigh = true;
+            expected++;
+        }
+        CHECK(reports.size() == expected);
+    }
+    CHECK(expected > 100);
+    for (size_t i = 0; i < reports.size(); i++)
+    {
+        CHECK(reports[i].mark == (i % 2 == 0 ? FIFO_WATERMARK_HIGH : FIFO_WATERMARK_LOW));
+        CHECK(reports[i].mark == FIFO_WATERMARK_HIGH ? reports[i].used >= 48 : reports[i].used <= 16);
+    }
+}
+
+TEST_CASE(fifo_watermark_init_buffer_reports_pending_low)
+{
+    uint8_t storage[32];
+    uint8_t data[32] = {0};
+    MarkedBytes fifo;
+    std::vector<Report> reports;
+
+    fifo.initBuffer(storage, sizeof(storage));
+    fifo.setWatermarks(24, 8, record, &reports);
+    fifo.write(data, 30);
+    REQUIRE(reports.size() == 1);
+
+    // Emptied by initBuffer(): the paused producer hears about it
+    fifo.initBuffer(storage, sizeof(storage));
+    REQUIRE(reports.size() == 2);
+    CHECK(reports[1].mark == FIFO_WATERMARK_LOW);
+    CHECK(reports[1].used == 0);
+
+    // Nothing pending, nothing reported; the high mark is armed again
+    fifo.initBuffer(storage, sizeof(storage));
+    CHECK(reports.size() == 2);
+    fifo.write(data, 24);
+    CHECK(reports.size() == 3);
+
+    // setWatermarks() drops a pending low mark, NULL disables the marks
+    fifo.setWatermarks(24, 8, record, &reports);
+    fifo.initBuffer(storage, sizeof(storage));
+    CHECK(reports.size() == 3);
+    fifo.setWatermarks(24, 8, NULL, NULL);
+    fifo.write(data, 30);
+    fifo.initBuffer(storage, sizeof(storage));
+    CHECK(reports.size() == 3);
+}
+
+struct Concurrent
+{
+    FiFoWatermarks marks;
+    std::atomic<int32_t> used;
+    std::atomic<uint32_t> highs;
+    std::atomic<uint32_t> lows;
+    std::atomic<uint32_t> inside;
+    std::atomic<uint32_t> errors;
+    std::atomic<int32_t> last;
+};
+
+static void countReport(FIFO_Watermark_e mark, uint16_t, void *context)
+{
+    Concurrent &c = *(Concurrent *)context;
+    if (c.inside.fetch_add(1) != 0)
+        c.errors.fetch_add(1);
+    if (c.last.exchange(mark) == mark)
+        c.errors.fetch_add(1);
+    (mark == FIFO_WATERMARK_HIGH ? c.highs : c.lows).fetch_add(1);
+    c.inside.fetch_sub(1);
+}
+
+// Same order as the FiFo: hook after the index update, then settle
+static void settle(Concurrent &c, bool reported)
+{
+    while (reported)
+        reported = c.marks.drained((uint16_t)c.used.load()) || c.marks.filled((uint16_t)c.used.load());
+}
+
+TEST_CASE(fifo_watermark_concurrent_sides_alternate)
+{
+    const int32_t capacity = 64;
+    const uint32_t count = 200000;
+    Concurrent c;
+
+    c.used.store(0);
+    c.highs.store(0);
+    c.lows.store(0);
+    c.inside.store(0);
+    c.errors.store(0);
+    c.last.store(FIFO_WATERMARK_LOW);
+    c.marks.watermarks(40, 8, countReport, &c);
+
+    std::thread producer([&]() {
+        for (uint32_t i = 0; i < count; i++)
+        {
+            while (c.used.load() >= capacity)
+                std::this_thread::yield();
+            uint16_t used = (uint16_t)(c.used.fetch_add(1) + 1);
+            settle(c, c.marks.filled(used));
+        }
+    });
+    std::thread consumer([&]() {
+        for (uint32_t i = 0; i < count; i++)
+        {
+            while (c.used.load() <= 0)
+                std::this_thread::yield();
+            uint16_t used = (uint16_t)(c.used.fetch_sub(1) - 1);
+            settle(c, c.marks.drained(used));
+        }
+    });
+    producer.join();
+    consumer.join();
+
+    CHECK(c.errors.load() == 0);
+    CHECK(c.highs.load() > 0);
+    // Drained to 0 in the end, so the last high mark got its low mark
+    CHECK(c.highs.load() == c.lows.load());
+    CHECK(c.last.load() == FIFO_WATERMARK_LOW);
+}
@@ -0,0 +1,200 @@
+/*
+ * FrameExchange tests for queue and latest mode, single and multi threaded.
+ */
+#include <atomic>
+#include <string.h>
+#include <thread>
+#include <vector>
+#include "FrameExchange.h"
+#include "Test.h"
+
+struct Frames
+{
+    std::vector<uint32_t> storage;
+    uint8_t *frames[FRAME_EXCHANGE_MAX_FRAMES];
+
+    Frames(uint8_t count, uint32_t words) : storage((size_t)count * words)
+    {
+        for (uint8_t i = 0; i < count; i++)
+            frames[i] = (uint8_t *)&storage[(size_t)i * words];
+    }
+};
+
+// Every word of a frame holds its sequence number, a torn frame mixes two
+static void fillFrame(uint8_t *frame, uint32_t words, uint32_t sequence)
+{
+    for (uint32_t i = 0; i < words; i++)
+        memcpy(frame + i * sizeof(uint32_t), &sequence, sizeof(sequence));
+}
+
+static bool intactFrame(const uint8_t *frame, uint32_t words, uint32_t &sequence)
+{
+    bool intact = true;
+    memcpy(&sequence, frame, sizeof(sequence));
+    for (uint32_t i = 1; i < words && intact; i++)
+        intact = memcmp(frame + i * sizeof(uint32_t), &sequence, sizeof(sequence)) == 0;
+    return intact;
+}
+
+TEST_CASE(frame_exchange_queue_ping_pong)
+{
+    Frames frames(2, 4);
+    FrameExchange exchange;
+    uint32_t length = 0;
+
+    CHECK(!exchange.initBuffers(frames.frames, 1, 16));
+    CHECK(exchange.acquire_write() == NULL);
+    REQUIRE(exchange.initBuffers(frames.frames, 2, 16));
+    CHECK(exchange.acquire_read() == NULL);
+
+    uint8_t *first = exchange.acquire_write();
+    CHECK(first == frames.frames[0]);
+    CHECK(exchange.acquire_write() == first);
+    exchange.publish(100);
+    uint8_t *second = exchange.acquire_write();
+    CHECK(second == frames.frames[1]);
+    exchange.publish(5);
+
+    // Both frames wait for the consumer
+    CHECK(exchange.acquire_write() == NULL);
+    CHECK(exchange.acquire_read(&length) == first);
+    CHECK(length == 16);
+    CHECK(exchange.acquire_read() == first);
+    exchange.release();
+    CHECK(exchange.acquire_write() == first);
+    CHECK(exchange.acquire_read(&length) == second);
+    CHECK(length == 5);
+    exchange.release();
+    CHECK(exchange.acquire_read() == NULL);
+    CHECK(exchange.dropped() == 0);
+}
+
+TEST_CASE(frame_exchange_latest_keeps_newest)
+{
+    Frames frames(4, 4);
+    FrameExchange exchange;
+    uint32_t sequence = 0;
+
+    CHECK(!exchange.initBuffers(frames.frames, 2, 16, FRAME_EXCHANGE_LATEST));
+    REQUIRE(exchange.initBuffers(frames.frames, 4, 16, FRAME_EXCHANGE_LATEST));
+    CHECK(exchange.frames() == 3);
+    CHECK(exchange.acquire_read() == NULL);
+
+    for (uint32_t s = 1; s <= 3; s++)
+    {
+        fillFrame(exchange.acquire_write(), 4, s);
+        exchange.publish();
+    }
+    CHECK(exchange.dropped() == 2);
+
+    const uint8_t *frame = exchange.acquire_read();
+    REQUIRE(frame != NULL);
+    CHECK(intactFrame(frame, 4, sequence) && sequence == 3);
+
+    // The producer never gets the frame the consumer holds
+    for (uint32_t s = 4; s <= 10; s++)
+    {
+        uint8_t *back = exchange.acquire_write();
+        CHECK(back != frame);
+        fillFrame(back, 4, s);
+        exchange.publish();
+    }
+    CHECK(exchange.acquire_read() == frame);
+    CHECK(intactFrame(frame, 4, sequence) && sequence == 3);
+    exchange.release();
+
+    frame = exchange.acquire_read();
+    REQUIRE(frame != NULL);
+    CHECK(intactFrame(frame, 4, sequence) && sequence == 10);
+    exchange.release();
+    CHECK(exchange.acquire_read() == NULL);
+    CHECK(exchange.dropped() == 8);
+}
+
+TEST_CASE(frame_exchange_queue_threads_keep_order)
+{
+    const uint32_t words = 64;
+    const uint32_t count = 50000;
+    Frames frames(3, words);
+    FrameExchange exchange;
+    REQUIRE(exchange.initBuffers(frames.frames, 3, words * sizeof(uint32_t)));
+
+    std::thread producer([&]() {
+        for (uint32_t s = 0; s < count; s++)
+        {
+            uint8_t *frame;
+            while ((frame = exchange.acquire_write()) == NULL)
+                std::this_thread::yield();
+            fillFrame(frame, words, s);
+            exchange.publish(s % (words * sizeof(uint32_t)) + 1);
+        }
+    });
+
+    uint32_t expected = 0;
+    bool ordered = true;
+    while (expected < count)
+    {
+        uint32_t length = 0;
+        uint32_t sequence = 0;
+        const uint8_t *frame = exchange.acquire_read(&length);
+        if (frame == NULL)
+        {
+            std::this_thread::yield();
+            continue;
+        }
+        ordered = ordered && intactFrame(frame, words, sequence) && sequence == expected &&
+                  length == expected % (words * sizeof(uint32_t)) + 1;
+        exchange.release();
+        expected++;
+    }
+    producer.join();
+
+    CHECK(ordered);
+    CHECK(exchange.acquire_read() == NULL);
+    CHECK(exchange.dropped() == 0);
+}
+
+TEST_CASE(frame_exchange_latest_threads_see_increasing_frames)
+{
+    const uint32_t words = 64;
+    const uint32_t count = 50000;
+    Frames frames(3, words);
+    FrameExchange exchange;
+    std::atomic<bool> done(false);
+    REQUIRE(exchange.initBuffers(frames.frames, 3, words * sizeof(uint32_t), FRAME_EXCHANGE_LATEST));
+
+    std::thread producer([&]() {
+        for (uint32_t s = 1; s <= count; s++)
+        {
+            fillFrame(exchange.acquire_write(), words, s);
+            exchange.publish();
+        }
+        done.store(true);
+    });
+
+    uint32_t last = 0;
+    uint32_t consumed = 0;
+    bool valid = true;
+    while (true)
+    {
+        bool finished = done.load();
+        uint32_t sequence = 0;
+        const uint8_t *frame = exchange.acquire_read();
+        if (frame != NULL)
+        {
+            valid = valid && intactFrame(frame, words, sequence) && sequence > last;
+            last = sequence;
+            consumed++;
+            exchange.release();
+        }
+        else if (finished)
+        {
+            break;
+        }
+    }
+    producer.join();
+
+    CHECK(valid);
+    CHECK(last == count);
+    CHECK(consumed + exchange.dropped() == count);
+}
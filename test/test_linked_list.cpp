@@ -0,0 +1,108 @@
+/*
+ * LinkedList iterator tests.
+ */
+#include <algorithm>
+#include <iterator>
+#include <numeric>
+#include <type_traits>
+#include <vector>
+#include "LinkedList.h"
+#include "Test.h"
+
+static void fill(LinkedList<int> &list, std::vector<ListEntry<int> > &entries)
+{
+    for (size_t i = 0; i < entries.size(); i++)
+    {
+        int value = (int)i * 3;
+        entries[i].data(value);
+        list.push_back(entries[i]);
+    }
+}
+
+TEST_CASE(linked_list_iterates_in_order)
+{
+    std::vector<ListEntry<int> > entries(10);
+    LinkedList<int> list;
+    fill(list, entries);
+
+    int expected = 0;
+    for (int &value : list)
+    {
+        CHECK(value == expected);
+        expected += 3;
+    }
+    CHECK(expected == 30);
+    CHECK(std::distance(list.begin(), list.end()) == 10);
+    CHECK(std::accumulate(list.begin(), list.end(), 0) == 135);
+    CHECK(std::find(list.begin(), list.end(), 12).entry() == &entries[4]);
+    CHECK(std::find(list.begin(), list.end(), 13) == list.end());
+}
+
+TEST_CASE(linked_list_iterators_are_independent)
+{
+    std::vector<ListEntry<int> > entries(6);
+    LinkedList<int> list;
+    fill(list, entries);
+
+    // Nested walks over the same list used to share one static cursor
+    int pairs = 0;
+    for (LinkedList<int>::iterator a = list.begin(); a != list.end(); ++a)
+    {
+        for (LinkedList<int>::iterator b = list.begin(); b != list.end(); b++)
+        {
+            pairs += *a < *b;
+        }
+    }
+    CHECK(pairs == 15);
+
+    // Elements are accessed in place
+    for (LinkedList<int>::iterator it = list.begin(); it != list.end(); ++it)
+        *it += 1;
+    CHECK(*entries[5].data() == 16);
+
+    const LinkedList<int> &constant = list;
+    LinkedList<int>::const_iterator c = constant.begin();
+    LinkedList<int>::const_iterator converted = list.begin();
+    CHECK(c == converted);
+    CHECK(*c == 1);
+    CHECK(list.cbegin() == c && list.cend() == constant.end());
+
+    // The conversion only goes one way
+    static_assert(std::is_convertible<LinkedList<int>::iterator, LinkedList<int>::const_iterator>::value,
+                  "iterator converts to const_iterator");
+    static_assert(!std::is_convertible<LinkedList<int>::const_iterator, LinkedList<int>::iterator>::value,
+                  "const_iterator must not convert to iterator");
+    static_assert(!std::is_convertible<LinkedList<long>::iterator, LinkedList<int>::const_iterator>::value,
+                  "iterators of other element types do not convert");
+}
+
+TEST_CASE(linked_list_empty_list_has_no_elements)
+{
+    LinkedList<int> list;
+    CHECK(list.begin() == list.end());
+    CHECK(list.for_each_chunk(4, [](LinkedList<int>::iterator, LinkedList<int>::iterator) {}) == 0);
+}
+
+TEST_CASE(linked_list_chunks_cover_the_list_once)
+{
+    std::vector<ListEntry<int> > entries(11);
+    LinkedList<int> list;
+    fill(list, entries);
+
+    std::vector<int> seen;
+    std::vector<long> lengths;
+    uint16_t chunks = list.for_each_chunk(4, [&](LinkedList<int>::iterator first, LinkedList<int>::iterator last) {
+        lengths.push_back(std::distance(first, last));
+        for (; first != last; ++first)
+            seen.push_back(*first);
+    });
+
+    CHECK(chunks == 4);
+    CHECK(lengths.size() == 4 && lengths[0] == 3 && lengths[1] == 3 && lengths[2] == 3 && lengths[3] == 2);
+    CHECK(seen.size() == 11);
+    for (size_t i = 0; i < seen.size(); i++)
+        CHECK(seen[i] == (int)i * 3);
+
+    // More chunks than entries gives one entry per chunk
+    CHECK(list.for_each_chunk(50, [](LinkedList<int>::iterator, LinkedList<int>::iterator) {}) == 11);
+}
@@ -0,0 +1,62 @@
+/*
+ * Test driver, linked into every test executable.
+ *
+ * Usage: test_<name> [<filter>]
+ *
+ *   <filter>  only run cases whose name contains the given text
+ */
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+#include "Test.h"
+
+struct RegisteredCase
+{
+    const char *name;
+    TestCaseFunction function;
+};
+
+static std::vector<RegisteredCase> &cases(void)
+{
+    static std::vector<RegisteredCase> registered;
+    return registered;
+}
+
+static uint32_t g_failures = 0;
+
+TestCase::TestCase(const char *name, TestCaseFunction function)
+{
+    RegisteredCase c = {name, function};
+    cases().push_back(c);
+}
+
+void testFailure(const char *file, int line, const char *expression)
+{
+    fprintf(stderr, "%s:%d: check failed: %s\n", file, line, expression);
+    fflush(stderr);
+    g_failures++;
+}
+
+int main(int argc, char **argv)
+{
+    const char *filter = argc > 1 ? argv[1] : NULL;
+    uint32_t failed = 0;
+    uint32_t run = 0;
+
+    for (size_t i = 0; i < cases().size(); i++)
+    {
+        if (filter != NULL && strstr(cases()[i].name, filter) == NULL)
+            continue;
+
+        uint32_t before = g_failures;
+        cases()[i].function();
+        run++;
+        if (g_failures != before)
+            failed++;
+        printf("%-40s %s\n", cases()[i].name, g_failures != before ? "FAILED" : "ok");
+        fflush(stdout);
+    }
+
+    printf("%u cases, %u failed\n", run, failed);
+    return failed == 0 && run > 0 ? 0 : 1;
+}
@@ -0,0 +1,171 @@
+/*
+ * ObjectPool and ObjectPoolCache tests: no slot is handed out twice.
+ */
+#include <atomic>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+#include "ObjectPool.h"
+#include "Test.h"
+
+struct Counted
+{
+    static std::atomic<int32_t> alive;
+    uint32_t owner;
+    uint32_t value;
+
+    Counted(uint32_t o, uint32_t v) : owner(o), value(v) { alive.fetch_add(1); }
+    ~Counted() { alive.fetch_sub(1); }
+};
+
+std::atomic<int32_t> Counted::alive(0);
+
+TEST_CASE(object_pool_hands_out_every_slot_once)
+{
+    ObjectPool<Counted> pool(100);
+    std::set<uint16_t> indices;
+
+    CHECK(pool.capacity() == 100);
+    CHECK(((uintptr_t)pool.get(0) % FIFO_CACHE_LINE_SIZE) == 0);
+    for (uint32_t i = 0; i < 100; i++)
+    {
+        uint16_t index = pool.acquire(1u, i);
+        REQUIRE(index != ObjectPool<Counted>::NONE);
+        CHECK(indices.insert(index).second);
+        CHECK(pool.get(index)->value == i);
+        CHECK(pool.indexOf(pool.get(index)) == index);
+    }
+    CHECK(pool.acquire(1u, 0u) == ObjectPool<Counted>::NONE);
+    CHECK(pool.available() == 0);
+    CHECK(Counted::alive.load() == 100);
+
+    for (std::set<uint16_t>::iterator it = indices.begin(); it != indices.end(); ++it)
+        pool.release(*it);
+    CHECK(pool.available() == 100);
+    CHECK(Counted::alive.load() == 0);
+
+    // Invalid indices are ignored
+    pool.release(ObjectPool<Counted>::NONE);
+    CHECK(pool.get(100) == NULL);
+    Counted outside(0, 0);
+    CHECK(pool.indexOf(&outside) == ObjectPool<Counted>::NONE);
+    CHECK(pool.available() == 100);
+}
+
+TEST_CASE(object_pool_handles_release_on_scope_exit)
+{
+    ObjectPool<Counted> pool(2);
+    {
+        ObjectPoolHandle<Counted> a = pool.make(1u, 10u);
+        ObjectPoolHandle<Counted> b = pool.make(2u, 20u);
+        ObjectPoolHandle<Counted> c = pool.make(3u, 30u);
+        CHECK(a.valid() && b.valid() && !c.valid());
+        CHECK(c.get() == NULL);
+        CHECK(a->value == 10 && (*b).value == 20);
+
+        ObjectPoolHandle<Counted> moved(std::move(a));
+        CHECK(!a.valid() && moved.valid());
+        b = std::move(moved);
+        CHECK(pool.available() == 1);
+        CHECK(b->value == 10);
+
+        uint16_t index = b.detach();
+        CHECK(!b.valid());
+        CHECK(pool.available() == 1);
+        pool.release(index);
+    }
+    CHECK(pool.available() == 2);
+    CHECK(Counted::alive.load() == 0);
+}
+
+TEST_CASE(object_pool_concurrent_acquire_release_without_duplicates)
+{
+    const uint16_t capacity = 64;
+    const uint32_t threads = 8;
+    const uint32_t rounds = 20000;
+    ObjectPool<Counted> pool(capacity);
+    std::vector<std::atomic<uint8_t> > owned(capacity);
+    std::atomic<uint32_t> duplicates(0);
+    std::atomic<uint32_t> corrupted(0);
+    std::mutex lock;
+    std::vector<uint16_t> handoff;
+
+    for (uint16_t i = 0; i < capacity; i++)
+        owned[i].store(0);
+
+    std::vector<std::thread> workers;
+    for (uint32_t t = 0; t < threads; t++)
+    {
+        workers.push_back(std::thread([&, t]() {
+            // Odd threads go through a cache, all of them release objects
+            // acquired by other threads
+            ObjectPoolCache<Counted, 8> cache(pool);
+            std::vector<uint16_t> held;
+            uint32_t seed = 17 + t;
+
+            for (uint32_t r = 0; r < rounds; r++)
+            {
+                uint16_t index = t % 2 ? cache.acquire(t, r) : pool.acquire(t, r);
+                if (index != ObjectPool<Counted>::NONE)
+                {
+                    if (owned[index].exchange(1) != 0)
+                        duplicates.fetch_add(1);
+                    held.push_back(index);
+                }
+                if (!held.empty() && (held.size() > 4 || testRandom(seed) % 2))
+                {
+                    uint16_t victim = held.back();
+                    held.pop_back();
+                    Counted *object = pool.get(victim);
+                    if (object->owner != t)
+                        corrupted.fetch_add(1);
+                    if (testRandom(seed) % 4 == 0)
+                    {
+                        std::lock_guard<std::mutex> guard(lock);
+                        handoff.push_back(victim);
+                        continue;
+                    }
+                    owned[victim].store(0);
+                    t % 2 ? cache.release(victim) : pool.release(victim);
+                }
+                uint16_t foreign = ObjectPool<Counted>::NONE;
+                {
+                    std::lock_guard<std::mutex> guard(lock);
+                    if (!handoff.empty())
+                    {
+                        foreign = handoff.back();
+                        handoff.pop_back();
+                    }
+                }
+                if (foreign != ObjectPool<Counted>::NONE)
+                {
+                    owned[foreign].store(0);
+                    t % 2 ? cache.release(foreign) : pool.release(foreign);
+                }
+            }
+            for (size_t i = 0; i < held.size(); i++)
+            {
+                owned[held[i]].store(0);
+                pool.release(held[i]);
+            }
+        }));
+    }
+    for (size_t t = 0; t < workers.size(); t++)
+        workers[t].join();
+    for (size_t i = 0; i < handoff.size(); i++)
+        pool.release(handoff[i]);
+
+    CHECK(duplicates.load() == 0);
+    CHECK(corrupted.load() == 0);
+    CHECK(Counted::alive.load() == 0);
+    CHECK(pool.available() == capacity);
+
+    // The free stack is intact: every slot comes back exactly once
+    std::set<uint16_t> indices;
+    for (uint16_t i = 0; i < capacity; i++)
+        CHECK(indices.insert(pool.acquire(0u, 0u)).second);
+    CHECK(indices.count(ObjectPool<Counted>::NONE) == 0);
+    for (std::set<uint16_t>::iterator it = indices.begin(); it != indices.end(); ++it)
+        pool.release(*it);
+}
@@ -0,0 +1,140 @@
+/*
+ * PriorityQueue tests against std::priority_queue and std::multimap as reference.
+ */
+#include <functional>
+#include <map>
+#include <queue>
+#include <vector>
+#include "PriorityQueue.h"
+#include "Test.h"
+
+template <uint8_t Arity>
+static void randomOperations(uint32_t seed)
+{
+    typedef PriorityQueue<uint32_t, PriorityQueueLess<uint32_t>, Arity> Queue;
+    typedef std::priority_queue<uint32_t, std::vector<uint32_t>, std::greater<uint32_t> > Reference;
+    std::vector<uint8_t> storage(PRIORITY_QUEUE_CALCULATE_BUFFERSIZE(200, uint32_t, false));
+    Queue queue;
+    Reference reference;
+
+    queue.initBuffer(&storage[0], (uint16_t)storage.size());
+    CHECK(queue.capacity() == 200);
+    for (uint32_t step = 0; step < 20000; step++)
+    {
+        uint32_t op = testRandom(seed) % 5;
+        uint32_t value = testRandom(seed) % 1000;
+
+        if (op <= 1)
+        {
+            CHECK(queue.write(value) == (reference.size() < 200));
+            if (reference.size() < 200)
+                reference.push(value);
+        }
+        else if (op == 2)
+        {
+            uint32_t batch[40];
+            uint16_t count = (uint16_t)(testRandom(seed) % 40);
+            for (uint16_t i = 0; i < count; i++)
+                batch[i] = testRandom(seed) % 1000;
+            uint16_t added = queue.push_range(batch, count);
+            uint16_t room = (uint16_t)(200 - reference.size());
+            CHECK(added == (count < room ? count : room));
+            for (uint16_t i = 0; i < added; i++)
+                reference.push(batch[i]);
+        }
+        else if (!reference.empty())
+        {
+            CHECK(queue.peek() == reference.top());
+            CHECK(queue.read() == reference.top());
+            reference.pop();
+        }
+        CHECK(queue.size() == reference.size());
+        CHECK(queue.isFull() == (reference.size() == 200));
+    }
+    while (!reference.empty())
+    {
+        CHECK(queue.read() == reference.top());
+        reference.pop();
+    }
+    CHECK(!queue.dataAvailable());
+    CHECK(queue.read() == 0);
+}
+
+TEST_CASE(priority_queue_matches_reference_for_all_arities)
+{
+    randomOperations<2>(1);
+    randomOperations<3>(2);
+    randomOperations<4>(3);
+    randomOperations<8>(4);
+}
+
+struct Tagged
+{
+    uint32_t key;
+    uint32_t tag;
+};
+
+struct TaggedLess
+{
+    bool operator()(const Tagged &a, const Tagged &b) const { return a.key < b.key; }
+};
+
+TEST_CASE(priority_queue_stable_keeps_write_order_of_equal_keys)
+{
+    typedef PriorityQueue<Tagged, TaggedLess, 4, true> Queue;
+    std::vector<uint8_t> storage(PRIORITY_QUEUE_CALCULATE_BUFFERSIZE(128, Tagged, true));
+    std::multimap<uint32_t, uint32_t> reference;
+    Queue queue;
+    uint32_t seed = 77;
+    uint32_t tag = 0;
+
+    queue.initBuffer(&storage[0], (uint16_t)storage.size());
+    for (uint32_t step = 0; step < 20000; step++)
+    {
+        uint32_t op = testRandom(seed) % 4;
+        if (op == 0 && reference.size() < 100)
+        {
+            // Bulk insert rebuilds the heap, write order must still hold
+            Tagged batch[28];
+            for (uint16_t i = 0; i < 28; i++)
+            {
+                batch[i].key = testRandom(seed) % 5;
+                batch[i].tag = tag++;
+                reference.insert(std::make_pair(batch[i].key, batch[i].tag));
+            }
+            CHECK(queue.push_range(batch, 28) == 28);
+        }
+        else if (op == 1 && reference.size() < 128)
+        {
+            Tagged t = {testRandom(seed) % 5, tag++};
+            CHECK(queue.write(t));
+            reference.insert(std::make_pair(t.key, t.tag));
+        }
+        else if (!reference.empty())
+        {
+            Tagged t = queue.read();
+            CHECK(t.key == reference.begin()->first);
+            CHECK(t.tag == reference.begin()->second);
+            reference.erase(reference.begin());
+        }
+    }
+    CHECK(queue.size() == reference.size());
+}
+
+TEST_CASE(priority_queue_without_buffer_rejects_writes)
+{
+    PriorityQueue<uint32_t> queue;
+    uint32_t values[6] = {6, 2, 5, 1, 4, 3};
+
+    CHECK(!queue.write(1));
+    CHECK(queue.push_range(values, 6) == 0);
+    CHECK(!queue.dataAvailable());
+
+    std::vector<uint32_t> storage(4);
+    queue.initBuffer((uint8_t *)&storage[0], PRIORITY_QUEUE_CALCULATE_BUFFERSIZE(4, uint32_t, false));
+    CHECK(queue.push_range(values, 6) == 4);
+    CHECK(queue.read() == 1);
+    CHECK(queue.read() == 2);
+    queue.clear();
+    CHECK(queue.size() == 0);
+}
@@ -0,0 +1,178 @@
+/*
+ * SharedFiFo tests over anonymous memfd segments.
+ */
+#include <atomic>
+#include <chrono>
+#include <sys/wait.h>
+#include <thread>
+#include "SharedFiFo.h"
+#include "Test.h"
+
+typedef SharedFiFo<uint64_t> Shared;
+
+static int64_t elapsedMs(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+TEST_CASE(shared_fifo_attach_shares_data_across_mappings)
+{
+    Shared producer;
+    Shared consumer;
+    uint64_t out[64];
+
+    REQUIRE(producer.create(NULL, 100));
+    CHECK(producer.getSizeOfBuffer() == 64);
+    REQUIRE(consumer.attach(producer.fd()));
+    CHECK(consumer.getSizeOfBuffer() == 64);
+
+    uint64_t next = 0;
+    uint64_t expected = 0;
+    bool same = true;
+    for (uint32_t round = 0; round < 100; round++)
+    {
+        // Batches of 40 wrap around the 64 element ring
+        uint64_t batch[40];
+        for (uint32_t i = 0; i < 40; i++)
+            batch[i] = next + i;
+        uint32_t written = producer.write(batch, 40);
+        CHECK(written == 40);
+        next += written;
+        CHECK(consumer.getUsedBufferSize() == 40);
+
+        uint32_t n = consumer.read(out, 64);
+        CHECK(n == 40);
+        for (uint32_t i = 0; i < n; i++)
+            same = same && out[i] == expected++;
+    }
+    CHECK(same);
+
+    // Full ring takes only what fits
+    uint64_t fill[70] = {0};
+    CHECK(producer.write(fill, 70) == 64);
+    CHECK(!producer.write(1));
+    CHECK(producer.getFreeBufferSpace() == 0);
+
+    // A segment of another element type is refused
+    SharedFiFo<uint32_t> other;
+    CHECK(!other.attach(producer.fd()));
+}
+
+TEST_CASE(shared_fifo_unattached_calls_fail_without_blocking)
+{
+    Shared fifo;
+    uint64_t value = 0;
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    CHECK(!fifo.waitForData(-1));
+    CHECK(!fifo.waitForSpace(-1));
+    CHECK(elapsedMs(start) < 100);
+    CHECK(!fifo.write(value));
+    CHECK(!fifo.read(value));
+    CHECK(fifo.closed());
+    CHECK(fifo.getSizeOfBuffer() == 0);
+    CHECK(fifo.fd() == -1);
+}
+
+TEST_CASE(shared_fifo_close_rejects_writes_and_keeps_queue)
+{
+    Shared producer;
+    Shared consumer;
+    uint64_t value = 0;
+
+    REQUIRE(producer.create(NULL, 8));
+    REQUIRE(consumer.attach(producer.fd()));
+    CHECK(producer.write(11));
+    CHECK(producer.write(12));
+    consumer.close();
+
+    CHECK(producer.closed());
+    CHECK(!producer.write(13));
+    CHECK(!producer.waitForSpace(-1));
+    CHECK(consumer.read(value) && value == 11);
+    CHECK(consumer.waitForData(-1));
+    CHECK(consumer.read(value) && value == 12);
+    CHECK(!consumer.waitForData(-1));
+}
+
+TEST_CASE(shared_fifo_timeout_is_a_deadline)
+{
+    Shared fifo;
+    REQUIRE(fifo.create(NULL, 8));
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    CHECK(!fifo.waitForData(50));
+    int64_t ms = elapsedMs(start);
+    CHECK(ms >= 45 && ms < 1000);
+
+    // Wake-ups without data must not restart the timeout
+    void *p = mmap(NULL, sizeof(SHARED_FIFO_Header_t), PROT_READ | PROT_WRITE, MAP_SHARED, fifo.fd(), 0);
+    REQUIRE(p != MAP_FAILED);
+    SHARED_FIFO_Header_t *header = (SHARED_FIFO_Header_t *)p;
+    std::atomic<bool> stop(false);
+    std::thread waker([&]() {
+        while (!stop.load())
+        {
+            syscall(SYS_futex, (uint32_t *)&header->write, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+    });
+
+    start = std::chrono::steady_clock::now();
+    CHECK(!fifo.waitForData(100));
+    ms = elapsedMs(start);
+    stop.store(true);
+    waker.join();
+    munmap(p, sizeof(SHARED_FIFO_Header_t));
+    CHECK(ms >= 95 && ms < 1000);
+}
+
+TEST_CASE(shared_fifo_transfers_between_processes)
+{
+    const uint64_t count = 200000;
+    Shared consumer;
+    REQUIRE(consumer.create(NULL, 256));
+
+    pid_t child = fork();
+    REQUIRE(child >= 0);
+    if (child == 0)
+    {
+        // The child inherits the descriptor and maps the segment itself
+        Shared producer;
+        int status = producer.attach(consumer.fd()) ? 0 : 1;
+        uint64_t next = 0;
+        while (status == 0 && next < count)
+        {
+            uint64_t batch[16];
+            uint32_t n = 0;
+            while (n < 16 && next + n < count)
+            {
+                batch[n] = next + n;
+                n++;
+            }
+            if (!producer.waitForSpace(1000))
+                status = 2;
+            else
+                next += producer.write(batch, n);
+        }
+        producer.close();
+        _exit(status);
+    }
+
+    uint64_t expected = 0;
+    bool same = true;
+    while (consumer.waitForData(5000))
+    {
+        uint64_t out[32];
+        uint32_t n = consumer.read(out, 32);
+        for (uint32_t i = 0; i < n; i++)
+            same = same && out[i] == expected++;
+    }
+    int status = -1;
+    waitpid(child, &status, 0);
+
+    CHECK(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+    CHECK(same);
+    CHECK(expected == count);
+    CHECK(consumer.closed());
+}
@@ -0,0 +1,131 @@
+/*
+ * SortedList tests against std::multimap as reference.
+ */
+#include <map>
+#include <vector>
+#include "SortedList.h"
+#include "Test.h"
+
+struct Tagged
+{
+    uint32_t key;
+    uint32_t tag;
+};
+
+struct TaggedLess
+{
+    bool operator()(const Tagged &a, const Tagged &b) const { return a.key < b.key; }
+};
+
+typedef SortedList<Tagged, TaggedLess> TaggedList;
+typedef std::multimap<uint32_t, uint32_t> Reference;
+
+static bool sameContent(TaggedList &list, const Reference &reference)
+{
+    bool same = list.size() == reference.size();
+    Reference::const_iterator it = reference.begin();
+    for (TaggedList::Entry *e = list.front(); same && e != NULL; e = e->next(), ++it)
+    {
+        same = it != reference.end() && e->data()->key == it->first && e->data()->tag == it->second;
+    }
+    return same;
+}
+
+TEST_CASE(sorted_list_orders_and_keeps_insertion_order_of_equal_keys)
+{
+    std::vector<TaggedList::Entry> pool(64);
+    TaggedList list;
+    Reference reference;
+    uint32_t seed = 7;
+
+    list.initBuffer(&pool[0], (uint32_t)pool.size());
+    for (uint32_t i = 0; i < 64; i++)
+    {
+        Tagged t = {testRandom(seed) % 8, i};
+        CHECK(list.insert_sorted(t) != NULL);
+        reference.insert(std::make_pair(t.key, t.tag));
+    }
+    CHECK(sameContent(list, reference));
+
+    Tagged extra = {1, 99};
+    CHECK(list.insert_sorted(extra) == NULL);
+    CHECK(list.size() == 64);
+}
+
+TEST_CASE(sorted_list_random_operations_match_reference)
+{
+    std::vector<TaggedList::Entry> pool(512);
+    TaggedList list;
+    Reference reference;
+    uint32_t seed = 12345;
+
+    list.initBuffer(&pool[0], (uint32_t)pool.size());
+    for (uint32_t step = 0; step < 20000; step++)
+    {
+        uint32_t op = testRandom(seed) % 6;
+        Tagged t = {testRandom(seed) % 300, step};
+
+        if (op <= 1)
+        {
+            bool inserted = list.insert_sorted(t) != NULL;
+            CHECK(inserted == (reference.size() < pool.size()));
+            if (inserted)
+                reference.insert(std::make_pair(t.key, t.tag));
+        }
+        else if (op == 2)
+        {
+            Reference::iterator it = reference.find(t.key);
+            CHECK(list.erase(t) == (it != reference.end()));
+            if (it != reference.end())
+                reference.erase(reference.lower_bound(t.key));
+        }
+        else if (op == 3)
+        {
+            TaggedList::Entry *lower = list.lower_bound(t);
+            TaggedList::Entry *upper = list.upper_bound(t);
+            TaggedList::Entry *found = list.find(t);
+            Reference::iterator rl = reference.lower_bound(t.key);
+            Reference::iterator ru = reference.upper_bound(t.key);
+
+            CHECK((lower == NULL) == (rl == reference.end()));
+            CHECK(lower == NULL || (lower->data()->key == rl->first && lower->data()->tag == rl->second));
+            CHECK((upper == NULL) == (ru == reference.end()));
+            CHECK(upper == NULL || (upper->data()->key == ru->first && upper->data()->tag == ru->second));
+            CHECK((found != NULL) == (rl != ru));
+            CHECK(found == NULL || found == lower);
+        }
+        else if (op == 4)
+        {
+            Tagged to = {t.key + testRandom(seed) % 40, 0};
+            uint32_t sum = 0;
+            uint32_t count = list.scan(t, to, [&](Tagged &v) { sum += v.key * 7 + v.tag; });
+            uint32_t expected = 0;
+            uint32_t expectedCount = 0;
+            for (Reference::iterator it = reference.lower_bound(t.key); it != reference.lower_bound(to.key); ++it)
+            {
+                expected += it->first * 7 + it->second;
+                expectedCount++;
+            }
+            CHECK(count == expectedCount);
+            CHECK(sum == expected);
+        }
+        else if (!reference.empty())
+        {
+            list.pop_front();
+            reference.erase(reference.begin());
+        }
+    }
+    CHECK(sameContent(list, reference));
+
+    list.clear();
+    CHECK(list.empty());
+    CHECK(list.front() == NULL);
+
+    // All entries are back in the pool
+    for (uint32_t i = 0; i < pool.size(); i++)
+    {
+        Tagged t = {i, i};
+        CHECK(list.insert_sorted(t) != NULL);
+    }
+    CHECK(list.size() == pool.size());
+}
@@ -0,0 +1,101 @@
+/*
+ * TimedRingBuffer tests against a scan over a std::deque as reference.
+ */
+#include <deque>
+#include <utility>
+#include "TimedRingBuffer.h"
+#include "Test.h"
+
+typedef TimedRingBuffer<uint32_t, uint32_t> Timed;
+typedef std::deque<std::pair<uint32_t, uint32_t> > Reference;
+
+static void appendSpan(const TimedRingSpan<uint32_t, uint32_t> &span, Reference &out)
+{
+    for (uint16_t i = 0; i < span.count; i++)
+        out.push_back(std::make_pair(span.keys[i], span.values[i]));
+}
+
+TEST_CASE(timed_ring_buffer_queries_match_scan)
+{
+    Timed ring(50);
+    Reference reference;
+    uint32_t seed = 31;
+    uint32_t key = 100;
+    uint32_t wrapped = 0;
+    uint32_t equalKeys = 0;
+
+    for (uint32_t step = 0; step < 20000; step++)
+    {
+        // Steps of 0 give runs of equal keys
+        key += testRandom(seed) % 4;
+        CHECK(ring.add(key, step));
+        reference.push_back(std::make_pair(key, step));
+        if (reference.size() > 50)
+            reference.pop_front();
+        CHECK(ring.length() == reference.size());
+        CHECK(ring.keyAt(-1) == key && ring.current() == step);
+        CHECK(ring.keyAt(-(int16_t)ring.length()) == reference.front().first);
+
+        uint32_t low = reference.front().first - 3;
+        uint32_t from = low + testRandom(seed) % (key - low + 6);
+        uint32_t to = low + testRandom(seed) % (key - low + 6);
+
+        TimedRingRange<uint32_t, uint32_t> range = ring.range(from, to);
+        Reference got;
+        appendSpan(range.first, got);
+        appendSpan(range.second, got);
+        Reference expected;
+        for (size_t i = 0; i < reference.size(); i++)
+        {
+            if (from <= reference[i].first && reference[i].first <= to)
+                expected.push_back(reference[i]);
+        }
+        CHECK(got == expected);
+        CHECK(range.size() == expected.size());
+        CHECK(range.second.count == 0 || range.first.count > 0);
+        wrapped += range.second.count > 0;
+        equalKeys += expected.size() > 1 && expected.front().first == expected.back().first;
+
+        uint32_t t = low + testRandom(seed) % (key - low + 6);
+        uint32_t found = 0;
+        const uint32_t *latest = ring.latest_before(t, &found);
+        Reference::reverse_iterator it = reference.rbegin();
+        while (it != reference.rend() && it->first > t)
+            ++it;
+        CHECK((latest == NULL) == (it == reference.rend()));
+        CHECK(latest == NULL || (*latest == it->second && found == it->first));
+    }
+    CHECK(wrapped > 100);
+    CHECK(equalKeys > 100);
+}
+
+TEST_CASE(timed_ring_buffer_rejects_older_keys_and_empty_ranges)
+{
+    Timed ring(4);
+    uint32_t found = 0;
+
+    CHECK(ring.range(0, 100).size() == 0);
+    CHECK(ring.latest_before(100) == NULL);
+
+    CHECK(ring.add(10, 1));
+    CHECK(ring.add(10, 2));
+    CHECK(!ring.add(9, 3));
+    CHECK(ring.length() == 2);
+
+    // Equal keys: the range holds both, latest_before() the newer one
+    CHECK(ring.range(10, 10).size() == 2);
+    CHECK(*ring.latest_before(10, &found) == 2 && found == 10);
+    CHECK(ring.latest_before(9) == NULL);
+
+    // from > to and ranges between samples are empty
+    CHECK(ring.add(20, 4));
+    CHECK(ring.range(20, 10).size() == 0);
+    CHECK(ring.range(11, 19).size() == 0);
+    TimedRingRange<uint32_t, uint32_t> none = ring.range(30, 40);
+    CHECK(none.first.count == 0 && none.second.count == 0);
+
+    ring.clear();
+    CHECK(ring.length() == 0);
+    CHECK(ring.add(1, 5));
+    CHECK(ring.range(0, 1).size() == 1);
+}
@@ -0,0 +1,144 @@
+/*
+ * TimingWheel tests against a map of expected firing ticks as reference.
+ */
+#include <map>
+#include <vector>
+#include "TimingWheel.h"
+#include "Test.h"
+
+// 3 levels of 8 slots: a range of 512 ticks, so cascades and parking are frequent
+typedef TimingWheel<uint32_t, 3, 3> Wheel;
+typedef std::map<uint32_t, uint64_t> Reference;
+
+TEST_CASE(timing_wheel_fires_at_expiry_like_reference)
+{
+    const uint32_t timers = 300;
+    std::vector<Wheel::Entry> entries(timers);
+    Reference reference;
+    Wheel wheel(1000);
+    uint32_t seed = 2024;
+    bool onTime = true;
+    bool expected = true;
+    uint32_t total = 0;
+
+    for (uint32_t i = 0; i < timers; i++)
+        entries[i].data(i);
+
+    for (uint32_t step = 0; step < 4000; step++)
+    {
+        uint32_t op = testRandom(seed) % 8;
+        uint32_t id = testRandom(seed) % timers;
+        Wheel::Entry &timer = entries[id];
+
+        if (op <= 3)
+        {
+            // Past, near, cascaded and parked expiries
+            uint32_t kind = testRandom(seed) % 4;
+            uint64_t span = kind == 0 ? 4 : kind == 1 ? 64 : kind == 2 ? 512 : 5000;
+            uint64_t expires = wheel.now() + testRandom(seed) % span;
+            if (kind == 0 && wheel.now() > 2)
+                expires -= 2;
+            wheel.schedule(timer, expires);
+            reference[id] = expires > wheel.now() ? expires : wheel.now() + 1;
+        }
+        else if (op == 4)
+        {
+            CHECK(wheel.cancel(timer) == (reference.erase(id) == 1));
+        }
+        else
+        {
+            uint64_t now = wheel.now() + (testRandom(seed) % 16 == 0 ? testRandom(seed) % 3000 : testRandom(seed) % 40);
+            uint32_t due = 0;
+            for (Reference::iterator it = reference.begin(); it != reference.end(); ++it)
+                due += it->second <= now;
+
+            uint32_t fired = wheel.advance(now, [&](Wheel::Entry &e) {
+                uint32_t firedId = *e.data();
+                Reference::iterator it = reference.find(firedId);
+                expected = expected && it != reference.end() && !e.scheduled();
+                onTime = onTime && it != reference.end() && it->second == wheel.now();
+                if (it != reference.end())
+                    reference.erase(it);
+                // Some timers re-arm themselves from the callback
+                if (firedId % 5 == 0)
+                {
+                    wheel.schedule(e, wheel.now() + 1 + firedId % 700);
+                    reference[firedId] = wheel.now() + 1 + firedId % 700;
+                }
+            });
+            CHECK(wheel.now() == now);
+            CHECK(fired >= due);
+            // Nothing due is left behind
+            for (Reference::iterator it = reference.begin(); it != reference.end(); ++it)
+                CHECK(it->second > now);
+            total += fired;
+        }
+        CHECK(wheel.size() == reference.size());
+    }
+    CHECK(expected);
+    CHECK(onTime);
+    CHECK(total > 1000);
+
+    for (uint32_t i = 0; i < timers; i++)
+        CHECK(entries[i].scheduled() == (reference.count(i) == 1));
+    wheel.clear();
+    CHECK(wheel.size() == 0);
+    for (uint32_t i = 0; i < timers; i++)
+        CHECK(!entries[i].scheduled());
+}
+
+TEST_CASE(timing_wheel_cascades_far_timers_in_order)
+{
+    Wheel wheel;
+    Wheel::Entry entries[4];
+    const uint64_t expiries[4] = {7, 100, 600, 5000};
+    std::vector<uint64_t> firedAt;
+
+    for (uint32_t i = 0; i < 4; i++)
+    {
+        entries[i].data(i);
+        wheel.schedule(entries[i], expiries[i]);
+    }
+    CHECK(wheel.size() == 4);
+
+    // Tick by tick and in one large step both hit every expiry exactly
+    for (uint64_t t = 1; t <= 700; t++)
+    {
+        wheel.advance(t, [&](Wheel::Entry &e) {
+            CHECK(*e.data() == firedAt.size());
+            firedAt.push_back(wheel.now());
+        });
+    }
+    CHECK(wheel.advance(10000, [&](Wheel::Entry &) { firedAt.push_back(wheel.now()); }) == 1);
+
+    REQUIRE(firedAt.size() == 4);
+    for (uint32_t i = 0; i < 4; i++)
+        CHECK(firedAt[i] == expiries[i]);
+    CHECK(wheel.size() == 0);
+
+    // An empty wheel jumps, an earlier tick is ignored
+    CHECK(wheel.advance(20000, [&](Wheel::Entry &) {}) == 0);
+    CHECK(wheel.now() == 20000);
+    wheel.advance(5, [&](Wheel::Entry &) {});
+    CHECK(wheel.now() == 20000);
+}
+
+TEST_CASE(timing_wheel_fire_can_cancel_batch_mates)
+{
+    Wheel wheel;
+    Wheel::Entry entries[3];
+    uint32_t fired = 0;
+
+    for (uint32_t i = 0; i < 3; i++)
+    {
+        entries[i].data(i);
+        wheel.schedule(entries[i], 10);
+    }
+    CHECK(wheel.advance(10, [&](Wheel::Entry &) {
+        fired++;
+        for (uint32_t i = 0; i < 3; i++)
+            wheel.cancel(entries[i]);
+    }) == 1);
+    CHECK(fired == 1);
+    CHECK(wheel.size() == 0);
+}
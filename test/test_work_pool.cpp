@@ -0,0 +1,178 @@
+/*
+ * FiFoWorkDeque and FiFoWorkPool tests: no element is lost or seen twice.
+ */
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "FiFoWorkPool.h"
+#include "Test.h"
+
+TEST_CASE(work_deque_pops_lifo_and_steals_oldest_half)
+{
+    std::vector<uint32_t> storage(12);
+    FiFoWorkDeque<uint32_t> deque;
+    uint32_t value = 0;
+    uint32_t out[8];
+
+    // 12 slots hold a capacity of 8
+    deque.initBuffer((uint8_t *)&storage[0], 12 * sizeof(uint32_t));
+    CHECK(deque.getSizeOfBuffer() == 8);
+    for (uint32_t i = 0; i < 8; i++)
+        CHECK(deque.write(i));
+    CHECK(!deque.write(8));
+    CHECK(deque.getFreeBufferSpace() == 0);
+
+    CHECK(deque.steal(out, 8) == 4);
+    CHECK(out[0] == 0 && out[3] == 3);
+    CHECK(deque.steal(out, 1) == 1);
+    CHECK(out[0] == 4);
+    CHECK(deque.getFreeBufferSpace() == 5);
+
+    CHECK(deque.read(value) && value == 7);
+    CHECK(deque.read(value) && value == 6);
+    CHECK(deque.read(value) && value == 5);
+    CHECK(!deque.read(value));
+    CHECK(deque.steal(out, 8) == 0);
+    CHECK(!deque.dataAvailable());
+}
+
+TEST_CASE(work_deque_concurrent_steals_lose_nothing)
+{
+    const uint32_t count = 200000;
+    const uint16_t thieves = 3;
+    std::vector<uint32_t> storage(8);
+    std::vector<std::atomic<uint8_t> > seen(count);
+    FiFoWorkDeque<uint32_t> deque;
+    std::atomic<bool> done(false);
+    std::atomic<uint32_t> taken(0);
+
+    for (uint32_t i = 0; i < count; i++)
+        seen[i].store(0, std::memory_order_relaxed);
+    deque.initBuffer((uint8_t *)&storage[0], 8 * sizeof(uint32_t));
+
+    std::vector<std::thread> threads;
+    for (uint16_t t = 0; t < thieves; t++)
+    {
+        threads.push_back(std::thread([&]() {
+            uint32_t out[4];
+            while (!done.load(std::memory_order_acquire) || deque.dataAvailable())
+            {
+                uint32_t n = deque.steal(out, 4);
+                for (uint32_t i = 0; i < n; i++)
+                    seen[out[i]].fetch_add(1, std::memory_order_relaxed);
+                taken.fetch_add(n, std::memory_order_relaxed);
+            }
+        }));
+    }
+
+    // Small deque: the owner keeps racing the thieves for the last elements
+    uint32_t value;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        while (!deque.write(i))
+        {
+            if (deque.read(value))
+            {
+                seen[value].fetch_add(1, std::memory_order_relaxed);
+                taken.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+        if (i % 3 == 0 && deque.read(value))
+        {
+            seen[value].fetch_add(1, std::memory_order_relaxed);
+            taken.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    done.store(true, std::memory_order_release);
+    for (size_t t = 0; t < threads.size(); t++)
+        threads[t].join();
+    while (deque.read(value))
+    {
+        seen[value].fetch_add(1, std::memory_order_relaxed);
+        taken.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    CHECK(taken.load() == count);
+    uint32_t wrong = 0;
+    for (uint32_t i = 0; i < count; i++)
+        wrong += seen[i].load(std::memory_order_relaxed) != 1;
+    CHECK(wrong == 0);
+}
+
+TEST_CASE(work_pool_steal_fits_own_deque)
+{
+    std::vector<uint32_t> storage(32);
+    FiFoWorkPool<uint32_t, 2> pool;
+    uint32_t value = 0;
+    uint32_t sum = 0;
+
+    pool.initWorker(0, (uint8_t *)&storage[0], 16 * sizeof(uint32_t));
+    pool.initWorker(1, (uint8_t *)&storage[16], 2 * sizeof(uint32_t));
+    for (uint32_t i = 0; i < 16; i++)
+        CHECK(pool.write(0, i));
+
+    // Worker 1 has room for two, so it takes three and keeps one
+    CHECK(pool.read(1, value));
+    CHECK(value == 0);
+    CHECK(pool.deque(1).getUsedBufferSize() == 2);
+    CHECK(pool.deque(0).getUsedBufferSize() == 13);
+
+    sum = value;
+    while (pool.read(1, value))
+        sum += value;
+    CHECK(sum == 16 * 15 / 2);
+    CHECK(!pool.dataAvailable());
+}
+
+TEST_CASE(work_pool_processes_every_item_once)
+{
+    // Item i spawns 2i+1 and 2i+2, tiny deques force steals and overflow
+    const uint16_t workers = 4;
+    const uint32_t count = 100000;
+    typedef FiFoWorkPool<uint32_t, workers> Pool;
+    std::vector<uint32_t> storage(workers * 4);
+    std::vector<std::atomic<uint8_t> > seen(count);
+    std::atomic<uint32_t> processed(0);
+    Pool pool;
+
+    for (uint32_t i = 0; i < count; i++)
+        seen[i].store(0, std::memory_order_relaxed);
+    for (uint16_t w = 0; w < workers; w++)
+        pool.initWorker(w, (uint8_t *)&storage[w * 4], 4 * sizeof(uint32_t));
+    pool.write(0, 0);
+
+    std::vector<std::thread> threads;
+    for (uint16_t w = 0; w < workers; w++)
+    {
+        threads.push_back(std::thread([&, w]() {
+            std::vector<uint32_t> local;
+            uint32_t item;
+            while (pool.wait(w, item))
+            {
+                local.push_back(item);
+                while (!local.empty())
+                {
+                    item = local.back();
+                    local.pop_back();
+                    seen[item].fetch_add(1, std::memory_order_relaxed);
+                    for (uint32_t child = 2 * item + 1; child <= 2 * item + 2 && child < count; child++)
+                    {
+                        if (!pool.write(w, child))
+                            local.push_back(child);
+                    }
+                    if (processed.fetch_add(1, std::memory_order_acq_rel) + 1 == count)
+                        pool.shutdown();
+                }
+            }
+        }));
+    }
+    for (size_t t = 0; t < threads.size(); t++)
+        threads[t].join();
+
+    CHECK(processed.load() == count);
+    uint32_t wrong = 0;
+    for (uint32_t i = 0; i < count; i++)
+        wrong += seen[i].load(std::memory_order_relaxed) != 1;
+    CHECK(wrong == 0);
+    CHECK(!pool.dataAvailable());
+}